@@ -0,0 +1,103 @@
+// Tick latency of the multi-snake Arena as the snake count grows. Snakes
+// wander at random but turn away from anything directly ahead of them;
+// only Arena::Step is timed.
+//
+// usage: arena_bench [grid_size] [ticks]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "Arena.h"
+#include "Random.h"
+
+static vec2i Ahead(const vec2i &head, Direction direction)
+{
+    switch (direction)
+    {
+    case Direction::Up:
+        return vec2i(head.x, head.y + 1);
+    case Direction::Down:
+        return vec2i(head.x, head.y - 1);
+    case Direction::Left:
+        return vec2i(head.x - 1, head.y);
+    case Direction::Right:
+        return vec2i(head.x + 1, head.y);
+    default:
+        return head;
+    }
+}
+
+static void Drive(Arena &arena, Random &rng)
+{
+    for (int i = 0; i < arena.SnakeCount(); i++)
+    {
+        const ArenaSnake &snake = arena.Snake(i);
+        if (!snake.alive)
+        {
+            continue;
+        }
+        if (rng.Below(8) == 0)
+        {
+            arena.Steer(i, static_cast<Direction>(rng.Below(4)));
+        }
+        if (arena.IsBlocked(Ahead(snake.body[0], snake.direction)))
+        {
+            Direction turn = static_cast<Direction>(rng.Below(4));
+            if (arena.IsBlocked(Ahead(snake.body[0], turn)))
+            {
+                turn = static_cast<Direction>((int(turn) + 2) & 3);
+            }
+            arena.Steer(i, turn);
+        }
+    }
+}
+
+static double Percentile(const std::vector<double> &sorted, double p)
+{
+    size_t index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[index];
+}
+
+int main(int argc, char **argv)
+{
+    int size = argc > 1 ? std::atoi(argv[1]) : 2048;
+    int ticks = argc > 2 ? std::atoi(argv[2]) : 500;
+    const int snakeCounts[] = {100, 250, 500, 1000, 2500, 5000, 10000};
+
+    std::printf("board %dx%d, %d ticks per run, latencies in microseconds\n", size, size, ticks);
+    std::printf("%8s %9s %9s %9s %9s %12s %9s\n",
+                "snakes", "p50", "p90", "p99", "max", "ns/snake", "deaths");
+
+    for (int snakeCount : snakeCounts)
+    {
+        Arena arena(size, size, snakeCount, snakeCount / 2 + 1, 42);
+        Random rng(7);
+        std::vector<double> latencies;
+        latencies.reserve(ticks);
+
+        for (int tick = 0; tick < ticks; tick++)
+        {
+            Drive(arena, rng);
+            auto start = std::chrono::steady_clock::now();
+            arena.Step();
+            auto end = std::chrono::steady_clock::now();
+            latencies.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+        }
+
+        std::sort(latencies.begin(), latencies.end());
+        double mean = 0.0;
+        for (double latency : latencies)
+        {
+            mean += latency;
+        }
+        mean /= latencies.size();
+
+        std::printf("%8d %9.1f %9.1f %9.1f %9.1f %12.1f %9llu\n", snakeCount,
+                    Percentile(latencies, 0.50), Percentile(latencies, 0.90),
+                    Percentile(latencies, 0.99), latencies.back(),
+                    mean * 1000.0 / snakeCount, arena.deaths);
+    }
+    return 0;
+}
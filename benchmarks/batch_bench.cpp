@@ -0,0 +1,75 @@
+// Steps/second of BatchEnv against the same number of separate GameState
+// objects, with the same random action stream. Single-threaded, so the
+// figures are per core.
+//
+// usage: batch_bench [games] [steps] [grid_size]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "BatchEnv.h"
+#include "Game.h"
+#include "Random.h"
+
+static const int ACTION_ROUNDS = 64; // pre-generated action rows, reused cyclically
+
+int main(int argc, char **argv)
+{
+    int games = argc > 1 ? std::atoi(argv[1]) : 4096;
+    int steps = argc > 2 ? std::atoi(argv[2]) : 2000;
+    int size = argc > 3 ? std::atoi(argv[3]) : DEFAULT_GRID_SIZE;
+
+    // a turn on roughly one step in four, as the headless runner does
+    Random input(7);
+    std::vector<Direction> actions(size_t(games) * ACTION_ROUNDS);
+    for (Direction &action : actions)
+    {
+        action = input.Below(4) == 0 ? static_cast<Direction>(input.Below(4)) : Direction::None;
+    }
+
+    std::printf("%d games on %dx%d, %d steps\n", games, size, size, steps);
+
+    BatchEnv env(games, size, size, 1);
+    auto start = std::chrono::steady_clock::now();
+    for (int step = 0; step < steps; step++)
+    {
+        env.Step(&actions[size_t(step % ACTION_ROUNDS) * games]);
+    }
+    auto end = std::chrono::steady_clock::now();
+    double batchSeconds = std::chrono::duration<double>(end - start).count();
+
+    std::vector<GameState> states(games);
+    for (int game = 0; game < games; game++)
+    {
+        states[game].SetGridSize(size, size);
+        states[game].Seed(1, game); // same streams as the BatchEnv games
+        states[game].Start();
+    }
+    unsigned long long finished = 0;
+    start = std::chrono::steady_clock::now();
+    for (int step = 0; step < steps; step++)
+    {
+        const Direction *row = &actions[size_t(step % ACTION_ROUNDS) * games];
+        for (int game = 0; game < games; game++)
+        {
+            GameState &state = states[game];
+            state.Steer(row[game]);
+            state.Step();
+            if (state.gameOver)
+            {
+                finished++;
+                state.Restart();
+                state.Start();
+            }
+        }
+    }
+    end = std::chrono::steady_clock::now();
+    double objectSeconds = std::chrono::duration<double>(end - start).count();
+
+    double total = double(games) * steps;
+    std::printf("%-16s %14s %12s\n", "engine", "steps/s/core", "games ended");
+    std::printf("%-16s %14.0f %12llu\n", "BatchEnv", total / batchSeconds, env.gamesFinished);
+    std::printf("%-16s %14.0f %12llu\n", "GameState array", total / objectSeconds, finished);
+    return 0;
+}
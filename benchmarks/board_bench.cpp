@@ -0,0 +1,93 @@
+// Memory and tick cost of Board across board sizes. A snake sweeps the
+// board row by row (so it never hits itself) doing the same work as a game
+// tick: collision lookup, head insert and tail removal, plus a fruit spawn
+// every few ticks.
+//
+// usage: board_bench [snake_length]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "Board.h"
+#include "Random.h"
+#include "RingBuffer.h"
+
+struct Cell
+{
+    int x, y;
+};
+
+static const int TICKS = 1000000;
+static const int SPAWN_EVERY = 16;
+
+int main(int argc, char **argv)
+{
+    int64_t snakeLength = argc > 1 ? std::atoll(argv[1]) : 4096;
+    const int sizes[] = {20, 64, 256, 1024, 4096, 16384, 65536};
+
+    std::printf("snake length up to %lld, %d ticks per board\n", (long long)snakeLength, TICKS);
+    std::printf("%12s %8s %10s %14s %16s\n",
+                "board", "mode", "ns/tick", "board bytes", "byte grid bytes");
+
+    Random rng(1234);
+    long long checksum = 0;
+    for (int size : sizes)
+    {
+        Board board;
+        board.Resize(size, size);
+        int64_t length = std::min<int64_t>(snakeLength, board.Area() / 2);
+
+        RingBuffer<Cell> snake(16);
+        Cell head = {0, 0};
+        int dx = 1;
+        snake.push_front(head);
+        board.SetOccupied(head.x, head.y, true);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int tick = 0; tick < TICKS; tick++)
+        {
+            // boustrophedon sweep, wrapping back to the bottom row
+            if (head.x + dx >= 0 && head.x + dx < size)
+            {
+                head.x += dx;
+            }
+            else
+            {
+                head.y = (head.y + 1) % size;
+                dx = -dx;
+            }
+
+            if (board.IsOccupied(head.x, head.y))
+            {
+                std::printf("unexpected collision\n");
+                return 1;
+            }
+            snake.push_front(head);
+            board.SetOccupied(head.x, head.y, true);
+
+            if (static_cast<int64_t>(snake.size()) > length)
+            {
+                board.SetOccupied(snake.back().x, snake.back().y, false);
+                snake.pop_back();
+            }
+
+            if (tick % SPAWN_EVERY == 0)
+            {
+                int fx, fy;
+                board.SampleFree(rng, fx, fy);
+                checksum += fx ^ fy;
+            }
+        }
+        auto end = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(end - start).count() / TICKS;
+
+        char name[32];
+        std::snprintf(name, sizeof(name), "%dx%d", size, size);
+        std::printf("%12s %8s %10.2f %14zu %16lld\n",
+                    name, board.IsDense() ? "dense" : "sparse", ns, board.MemoryBytes(),
+                    (long long)board.Area());
+    }
+    std::printf("checksum %lld\n", checksum);
+    return 0;
+}
@@ -0,0 +1,149 @@
+// Recording a frame into RenderCommands on one thread against recording it
+// in bands on a ThreadPool, each band into a buffer of its own, and
+// appending the bands in order on the submitting thread. The frame is a
+// checkered board of N x N cells, a snake across it and a line of text
+// recorded first on the top layer. Both frames are submitted to the CPU
+// backend and have to come out the same, or the run fails.
+//
+// usage: command_buffer_bench [frames] [threads]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "RenderCommands.h"
+#include "SoftwareRenderer.h"
+#include "ThreadPool.h"
+
+namespace
+{
+enum Layer : uint8_t
+{
+    BoardLayer,
+    SnakeLayer,
+    TextLayer,
+};
+
+const int IMAGE_SIZE = 512;
+
+// Board rows first to last - 1, then the snake's cells in them.
+void RecordRows(RenderCommands &commands, int size, int first, int last)
+{
+    float cell = 2.0f / size;
+    commands.SetLayer(BoardLayer);
+    for (int y = first; y < last; y++)
+    {
+        for (int x = 0; x < size; x++)
+        {
+            float shade = (x + y) % 2 ? 0.08f : 0.33f;
+            commands.Cell(-1.0f + (x + 0.5f) * cell, -1.0f + (y + 0.5f) * cell, cell * 0.9f, cell * 0.9f,
+                          shade, shade, 0.5f);
+        }
+    }
+
+    // a snake winding along every third row
+    commands.SetLayer(SnakeLayer);
+    for (int y = first; y < last; y++)
+    {
+        if (y % 3 == 0)
+        {
+            for (int x = 0; x < size; x++)
+            {
+                commands.Cell(-1.0f + (x + 0.5f) * cell, -1.0f + (y + 0.5f) * cell, cell * 0.9f, cell * 0.9f,
+                              0.0f, 0.7f, 0.1f);
+            }
+        }
+    }
+}
+
+double Seconds(std::chrono::steady_clock::time_point begin)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+}
+
+int main(int argc, char **argv)
+{
+    int frames = argc > 1 ? std::max(1, std::atoi(argv[1])) : 200;
+    int threads = argc > 2 ? std::max(1, std::atoi(argv[2])) : 0;
+    const int sizes[] = {64, 256, 1024};
+
+    ThreadPool pool(threads);
+    int bands = pool.ThreadCount();
+
+    // the text goes on top, whoever records it and whenever
+    std::vector<CellInstance> text;
+    for (int i = 0; i < 40; i++)
+    {
+        text.push_back({-0.8f + i * 0.04f, 0.9f, 0.03f, 0.03f, 0.9f, 0.9f, 0.9f});
+    }
+
+    std::printf("%d frames per size, %d recording threads\n", frames, bands);
+    std::printf("%6s %10s %8s %16s %16s %12s\n", "board", "quads", "draws", "1 thread us", "bands us",
+                "submit us");
+    int failures = 0;
+    for (int size : sizes)
+    {
+        RenderCommands single;
+        RenderCommands frame;
+        std::vector<RenderCommands> band(bands);
+        SoftwareRenderer bandTarget;
+
+        double singleSeconds = 0.0, bandSeconds = 0.0, submitSeconds = 0.0;
+        for (int i = 0; i < frames; i++)
+        {
+            auto begin = std::chrono::steady_clock::now();
+            single.Clear();
+            RecordRows(single, size, 0, size);
+            single.SetLayer(TextLayer);
+            single.Text(text);
+            singleSeconds += Seconds(begin);
+
+            begin = std::chrono::steady_clock::now();
+            frame.Clear();
+            frame.SetLayer(TextLayer);
+            frame.Text(text);
+            pool.ParallelFor(bands, 1,
+                             [&](size_t first, size_t last, int)
+                             {
+                                 for (size_t b = first; b < last; b++)
+                                 {
+                                     band[b].Clear();
+                                     RecordRows(band[b], size, int(b * size / bands), int((b + 1) * size / bands));
+                                 }
+                             });
+            for (const RenderCommands &commands : band)
+            {
+                frame.Append(commands);
+            }
+            bandSeconds += Seconds(begin);
+
+            begin = std::chrono::steady_clock::now();
+            bandTarget.BeginFrame(IMAGE_SIZE, IMAGE_SIZE, 0.08f, 0.1f, 0.12f);
+            bandTarget.Submit(frame);
+            bandTarget.EndFrame();
+            submitSeconds += Seconds(begin);
+        }
+
+        // the last frame of each, drawn once more on a target of its own
+        SoftwareRenderer checkSingle, checkBands;
+        checkSingle.BeginFrame(IMAGE_SIZE, IMAGE_SIZE, 0.08f, 0.1f, 0.12f);
+        checkSingle.Submit(single);
+        checkSingle.EndFrame();
+        checkBands.BeginFrame(IMAGE_SIZE, IMAGE_SIZE, 0.08f, 0.1f, 0.12f);
+        checkBands.Submit(frame);
+        checkBands.EndFrame();
+        if (std::memcmp(checkSingle.Pixels(), checkBands.Pixels(), IMAGE_SIZE * IMAGE_SIZE * 4) != 0 ||
+            checkSingle.drawCalls != checkBands.drawCalls)
+        {
+            std::printf("board %d: the banded frame differs from the one recorded on one thread\n", size);
+            failures++;
+        }
+
+        std::printf("%6d %10llu %8llu %16.1f %16.1f %12.1f\n", size, checkSingle.instances, checkBands.drawCalls,
+                    singleSeconds / frames * 1e6, bandSeconds / frames * 1e6, submitSeconds / frames * 1e6);
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,88 @@
+// Throughput of independent GameState instances sharded over a
+// work-stealing ThreadPool, for every thread count from 1 to N.
+//
+// usage: scaling_bench [games] [ticks_per_game] [max_threads]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "Game.h"
+#include "Random.h"
+#include "ThreadPool.h"
+
+static const size_t GRAIN = 64; // games per chunk
+
+// Per-worker state, padded so workers never share a cache line.
+struct alignas(64) WorkerState
+{
+    Random input;
+    unsigned long long gamesEnded = 0;
+};
+
+int main(int argc, char **argv)
+{
+    int gameCount = argc > 1 ? std::atoi(argv[1]) : 8192;
+    int ticks = argc > 2 ? std::atoi(argv[2]) : 1000;
+    int maxThreads = argc > 3 ? std::atoi(argv[3]) : int(std::thread::hardware_concurrency());
+    if (maxThreads < 1)
+    {
+        maxThreads = 1;
+    }
+
+    std::printf("%d games x %d ticks, up to %d threads\n", gameCount, ticks, maxThreads);
+    std::printf("%8s %14s %9s %11s %8s\n", "threads", "ticks/s", "speedup", "efficiency", "steals");
+
+    double baseline = 0.0;
+    for (int threadCount = 1; threadCount <= maxThreads; threadCount++)
+    {
+        std::vector<GameState> games(gameCount);
+        for (int i = 0; i < gameCount; i++)
+        {
+            games[i].Seed(1, i);
+            games[i].Start();
+        }
+
+        ThreadPool pool(threadCount);
+        std::vector<WorkerState> workers(threadCount);
+        for (int i = 0; i < threadCount; i++)
+        {
+            workers[i].input.Seed(1000, i); // one input stream per worker
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        pool.ParallelFor(games.size(), GRAIN, [&](size_t begin, size_t end, int worker)
+                         {
+                             WorkerState &state = workers[worker];
+                             for (size_t i = begin; i < end; i++)
+                             {
+                                 GameState &game = games[i];
+                                 for (int tick = 0; tick < ticks; tick++)
+                                 {
+                                     if (state.input.Below(4) == 0)
+                                     {
+                                         game.Steer(static_cast<Direction>(state.input.Below(4)));
+                                     }
+                                     game.Step();
+                                     if (game.gameOver)
+                                     {
+                                         state.gamesEnded++;
+                                         game.Restart();
+                                         game.Start();
+                                     }
+                                 }
+                             } });
+        auto end = std::chrono::steady_clock::now();
+
+        double seconds = std::chrono::duration<double>(end - start).count();
+        double rate = double(gameCount) * ticks / seconds;
+        if (threadCount == 1)
+        {
+            baseline = rate;
+        }
+        std::printf("%8d %14.0f %8.2fx %10.0f%% %8llu\n", threadCount, rate, rate / baseline,
+                    100.0 * rate / (baseline * threadCount), pool.StealCount());
+    }
+    return 0;
+}
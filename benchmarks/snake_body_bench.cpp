@@ -0,0 +1,88 @@
+// Compares the per-tick cost of moving the snake body stored in a
+// std::vector (insert at begin + pop_back, as UpdateGame used to do) with
+// the RingBuffer (push_front + pop_back), for lengths from 3 up to a full
+// board.
+//
+// usage: snake_body_bench [grid_width grid_height]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "RingBuffer.h"
+
+struct Cell
+{
+    int x, y;
+};
+
+static const int STEPS = 200000;
+
+// Walk the body around so every step writes a new head and drops the tail,
+// returning a checksum so the loop cannot be optimised away.
+template <typename Body, typename MoveFn>
+static double TimeSteps(Body &body, MoveFn move, long long &checksum)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < STEPS; i++)
+    {
+        Cell head = body[0];
+        head.x = (head.x + 1) & 1023;
+        move(body, head);
+        checksum += body[0].x + body[body.size() - 1].y;
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / STEPS;
+}
+
+int main(int argc, char **argv)
+{
+    int width = 20;
+    int height = 20;
+    if (argc == 3)
+    {
+        width = std::atoi(argv[1]);
+        height = std::atoi(argv[2]);
+    }
+    const size_t area = static_cast<size_t>(width) * height;
+
+    std::vector<size_t> lengths;
+    for (size_t length = 3; length < area; length *= 2)
+    {
+        lengths.push_back(length);
+    }
+    lengths.push_back(area - 1); // one free cell left to move into
+
+    std::printf("board %dx%d, %d steps per length\n", width, height, STEPS);
+    std::printf("%10s %14s %14s %8s\n", "length", "vector ns", "ring ns", "speedup");
+
+    long long checksum = 0;
+    for (size_t length : lengths)
+    {
+        std::vector<Cell> vec;
+        RingBuffer<Cell> ring(area);
+        for (size_t i = 0; i < length; i++)
+        {
+            Cell cell = {static_cast<int>(i % width), static_cast<int>(i / width)};
+            vec.push_back(cell);
+            ring.push_back(cell);
+        }
+
+        double vecNs = TimeSteps(vec, [](std::vector<Cell> &body, const Cell &head)
+                                 {
+                                     body.insert(body.begin(), head);
+                                     body.pop_back();
+                                 },
+                                 checksum);
+        double ringNs = TimeSteps(ring, [](RingBuffer<Cell> &body, const Cell &head)
+                                  {
+                                      body.pop_back();
+                                      body.push_front(head);
+                                  },
+                                  checksum);
+
+        std::printf("%10zu %14.2f %14.2f %7.1fx\n", length, vecNs, ringNs, vecNs / ringNs);
+    }
+    std::printf("checksum %lld\n", checksum);
+    return 0;
+}
@@ -0,0 +1,65 @@
+// Frame cost of the CPU render backend on a 20x20 board at thumbnail and
+// window sizes: the start screen, a game in progress (background copy,
+// snake and score) and the game-over screen, which has no cached layer.
+//
+// usage: software_render_bench [frames]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "Game.h"
+#include "GameRenderer.h"
+#include "SoftwareRenderer.h"
+
+int main(int argc, char **argv)
+{
+    int frames = argc > 1 ? std::max(1, std::atoi(argv[1])) : 2000;
+    const int sizes[][2] = {{160, 120}, {320, 240}, {800, 600}};
+
+    GameState game;
+    game.SetGridSize(DEFAULT_GRID_SIZE, DEFAULT_GRID_SIZE);
+    game.Seed(1);
+    GameSnapshot start, play, over;
+    game.TakeSnapshot(start);
+    game.Start();
+    for (int i = 0; i < 6; i++)
+    {
+        game.Step();
+    }
+    game.TakeSnapshot(play);
+    while (!game.gameOver)
+    {
+        game.Step();
+    }
+    game.TakeSnapshot(over);
+
+    const GameSnapshot *scenes[] = {&start, &play, &over};
+    const char *names[] = {"start", "play", "over"};
+
+    std::printf("%d frames per scene\n", frames);
+    std::printf("%10s %8s %14s\n", "size", "scene", "us/frame");
+    unsigned long long checksum = 0;
+    for (const auto &size : sizes)
+    {
+        SoftwareRenderer software;
+        for (int scene = 0; scene < 3; scene++)
+        {
+            RenderGame(software, *scenes[scene], 0.0f, size[0], size[1]); // warm up
+
+            auto begin = std::chrono::steady_clock::now();
+            for (int frame = 0; frame < frames; frame++)
+            {
+                RenderGame(software, *scenes[scene], 0.0f, size[0], size[1]);
+                checksum += software.Pixels()[frame % (size[0] * size[1])];
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+            char name[32];
+            std::snprintf(name, sizeof(name), "%dx%d", size[0], size[1]);
+            std::printf("%10s %8s %14.2f\n", name, names[scene], seconds / frames * 1e6);
+        }
+    }
+    std::printf("checksum %llu\n", checksum);
+    return 0;
+}
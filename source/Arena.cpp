@@ -0,0 +1,219 @@
+#include "Arena.h"
+
+static const int SPAWN_ATTEMPTS = 32;
+
+Arena::Arena(int width, int height, int snakeCount, int fruitCount, uint64_t seed)
+    : ticks(0), deaths(0), headOnCollisions(0), width(width), height(height),
+      snakes(snakeCount), fruits(fruitCount), nextHead(snakeCount), dies(snakeCount),
+      rng(seed)
+{
+    claims.reserve(snakeCount * 2);
+    fruitAt.reserve(fruitCount * 2);
+
+    for (int i = 0; i < snakeCount; i++)
+    {
+        snakes[i].body = RingBuffer<vec2i>(16);
+        Respawn(i);
+    }
+    for (int i = 0; i < fruitCount; i++)
+    {
+        if (!SpawnFruit(i))
+        {
+            parkedFruits.push_back(i);
+        }
+    }
+}
+
+void Arena::Steer(int snake, Direction direction)
+{
+    // same reversal guard as GameState::Steer
+    Direction current = snakes[snake].direction;
+    if (direction == Direction::None ||
+        (direction == Direction::Up && current == Direction::Down) ||
+        (direction == Direction::Down && current == Direction::Up) ||
+        (direction == Direction::Left && current == Direction::Right) ||
+        (direction == Direction::Right && current == Direction::Left))
+    {
+        return;
+    }
+    snakes[snake].direction = direction;
+}
+
+bool Arena::IsBlocked(const vec2i &cell) const
+{
+    return cell.x < 0 || cell.x >= width || cell.y < 0 || cell.y >= height ||
+           bodies.Test(cell.x, cell.y);
+}
+
+void Arena::Step()
+{
+    int count = SnakeCount();
+    claims.clear();
+
+    // Work out every new head against the board as it was at the start of
+    // the tick, and find heads that meet on the same cell.
+    for (int i = 0; i < count; i++)
+    {
+        ArenaSnake &snake = snakes[i];
+        dies[i] = 0;
+        if (!snake.alive)
+        {
+            continue;
+        }
+
+        vec2i head = snake.body[0];
+        switch (snake.direction)
+        {
+        case Direction::Up:
+            head.y++;
+            break;
+        case Direction::Down:
+            head.y--;
+            break;
+        case Direction::Left:
+            head.x--;
+            break;
+        case Direction::Right:
+            head.x++;
+            break;
+        case Direction::None:
+            break;
+        }
+        nextHead[i] = head;
+
+        if (IsBlocked(head))
+        {
+            dies[i] = 1;
+            continue;
+        }
+
+        auto claim = claims.emplace(Key(head), i);
+        if (!claim.second)
+        {
+            dies[i] = 1;
+            if (!dies[claim.first->second])
+            {
+                dies[claim.first->second] = 1;
+                headOnCollisions++;
+            }
+            headOnCollisions++;
+        }
+    }
+
+    // Move the survivors. Bodies of snakes that died are still on the
+    // board here, which is what the tests above were made against.
+    for (int i = 0; i < count; i++)
+    {
+        ArenaSnake &snake = snakes[i];
+        if (!snake.alive || dies[i])
+        {
+            continue;
+        }
+
+        const vec2i &head = nextHead[i];
+        snake.body.push_front(head);
+        bodies.Set(head.x, head.y);
+
+        auto fruit = fruitAt.find(Key(head));
+        if (fruit != fruitAt.end())
+        {
+            int index = fruit->second;
+            fruitAt.erase(fruit);
+            snake.score += 10;
+            if (!SpawnFruit(index))
+            {
+                parkedFruits.push_back(index);
+            }
+        }
+        else
+        {
+            const vec2i &tail = snake.body.back();
+            bodies.Clear(tail.x, tail.y);
+            snake.body.pop_back();
+        }
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        if (dies[i])
+        {
+            Kill(i);
+        }
+        if (!snakes[i].alive)
+        {
+            Respawn(i);
+        }
+    }
+
+    // fruit parked on a crowded board, as dead snakes above
+    for (size_t i = 0; i < parkedFruits.size();)
+    {
+        if (SpawnFruit(parkedFruits[i]))
+        {
+            parkedFruits[i] = parkedFruits.back();
+            parkedFruits.pop_back();
+        }
+        else
+        {
+            i++;
+        }
+    }
+    ticks++;
+}
+
+void Arena::Kill(int snake)
+{
+    ArenaSnake &dead = snakes[snake];
+    for (size_t i = 0; i < dead.body.size(); i++)
+    {
+        bodies.Clear(dead.body[i].x, dead.body[i].y);
+    }
+    dead.body.clear();
+    dead.alive = false;
+    deaths++;
+}
+
+// Drops a fresh three-cell snake facing right on a random free spot. Gives
+// up after a few tries on a crowded board; the next tick tries again.
+bool Arena::Respawn(int snake)
+{
+    for (int attempt = 0; attempt < SPAWN_ATTEMPTS; attempt++)
+    {
+        vec2i head(rng.Range(2, width - 2), rng.Range(0, height - 1));
+        if (bodies.Test(head.x, head.y) || bodies.Test(head.x - 1, head.y) ||
+            bodies.Test(head.x - 2, head.y) || bodies.Test(head.x + 1, head.y))
+        {
+            continue;
+        }
+
+        ArenaSnake &spawned = snakes[snake];
+        spawned.body.clear();
+        for (int i = 0; i < 3; i++)
+        {
+            spawned.body.push_back(vec2i(head.x - i, head.y));
+            bodies.Set(head.x - i, head.y);
+        }
+        spawned.direction = Direction::Right;
+        spawned.alive = true;
+        spawned.score = 0;
+        return true;
+    }
+    return false;
+}
+
+// Puts the fruit on a random free cell, or parks it off the board when a
+// few tries find none.
+bool Arena::SpawnFruit(int fruit)
+{
+    for (int attempt = 0; attempt < SPAWN_ATTEMPTS; attempt++)
+    {
+        vec2i cell(rng.Range(0, width - 1), rng.Range(0, height - 1));
+        if (!bodies.Test(cell.x, cell.y) && fruitAt.emplace(Key(cell), fruit).second)
+        {
+            fruits[fruit] = cell;
+            return true;
+        }
+    }
+    fruits[fruit] = vec2i(-1, -1);
+    return false;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "Game.h"
+#include "Random.h"
+#include "SparseBoard.h"
+
+struct ArenaSnake
+{
+    RingBuffer<vec2i> body; // [0] is the head
+    Direction direction = Direction::Right;
+    bool alive = false;
+    int score = 0;
+};
+
+// Many snakes on one large board. All snakes move at once each tick; a
+// snake dies when its new head leaves the board, lands on any body
+// (tails included, as in GameState) or lands on the same cell as another
+// snake's new head, in which case both die. Dead snakes are cleared from
+// the board and respawned at a random free spot. A snake or fruit that
+// finds no free spot on a crowded board tries again every tick.
+//
+// Collisions go through a SparseBoard over every body cell plus a per-tick
+// hash of claimed head cells, so a tick costs O(snakes) plus O(length) for
+// each snake that dies, instead of comparing every segment pair.
+class Arena
+{
+public:
+    Arena(int width, int height, int snakeCount, int fruitCount, uint64_t seed);
+
+    void Steer(int snake, Direction direction);
+    void Step();
+
+    // True if a head moving onto `cell` would die (wall or body).
+    bool IsBlocked(const vec2i &cell) const;
+
+    int Width() const { return width; }
+    int Height() const { return height; }
+    int SnakeCount() const { return static_cast<int>(snakes.size()); }
+    const ArenaSnake &Snake(int snake) const { return snakes[snake]; }
+    // Fruit waiting for room is at (-1, -1).
+    const std::vector<vec2i> &Fruits() const { return fruits; }
+
+    unsigned long long ticks;
+    unsigned long long deaths;
+    unsigned long long headOnCollisions; // deaths from two heads meeting
+
+private:
+    static uint64_t Key(const vec2i &cell)
+    {
+        return (uint64_t(uint32_t(cell.y)) << 32) | uint32_t(cell.x);
+    }
+
+    bool Respawn(int snake);
+    void Kill(int snake);
+    bool SpawnFruit(int fruit);
+
+    int width, height;
+    std::vector<ArenaSnake> snakes;
+    std::vector<vec2i> fruits;
+    std::unordered_map<uint64_t, int> fruitAt; // cell -> index into fruits
+    std::vector<int> parkedFruits;             // off the board, waiting for room
+    SparseBoard bodies;                        // every live body cell
+
+    // per-tick scratch
+    std::vector<vec2i> nextHead;
+    std::vector<uint8_t> dies;
+    std::unordered_map<uint64_t, int> claims; // new head cell -> first snake
+
+    Random rng;
+};
@@ -0,0 +1,198 @@
+#include "BatchEnv.h"
+
+#include <cassert>
+
+BatchEnv::BatchEnv(int gameCount, int width, int height, uint64_t seed)
+    : steps(0), gamesFinished(0), gamesWon(0), gameCount(gameCount),
+      width(width), height(height), area(width * height)
+{
+    assert(width >= Board::MIN_SIZE && height >= Board::MIN_SIZE);
+    assert(int64_t(width) * height <= Board::DENSE_CELL_LIMIT);
+
+    headX.assign(gameCount, 0);
+    headY.assign(gameCount, 0);
+    direction.assign(gameCount, uint8_t(Direction::Right));
+    length.assign(gameCount, 0);
+    fruitX.assign(gameCount, 0);
+    fruitY.assign(gameCount, 0);
+    score.assign(gameCount, 0);
+    done.assign(gameCount, 0);
+    finalScore.assign(gameCount, 0);
+
+    size_t cells = size_t(gameCount) * area;
+    occupancy.assign(cells, 0);
+    body.assign(cells, 0);
+    freeCells.assign(cells, 0);
+    freeSlot.assign(cells, 0);
+    bodyFirst.assign(gameCount, 0);
+    freeCount.assign(gameCount, 0);
+
+    nextX.assign(gameCount, 0);
+    nextY.assign(gameCount, 0);
+    hitWall.assign(gameCount, 0);
+
+    rngs.resize(gameCount);
+    for (int game = 0; game < gameCount; game++)
+    {
+        rngs[game].Seed(seed, game);
+    }
+
+    for (int game = 0; game < gameCount; game++)
+    {
+        size_t base = size_t(game) * area;
+        for (int32_t i = 0; i < area; i++)
+        {
+            freeCells[base + i] = i;
+            freeSlot[base + i] = i;
+        }
+        freeCount[game] = area;
+        ResetGame(game);
+    }
+}
+
+void BatchEnv::Step(const Direction *actions)
+{
+    const uint8_t none = uint8_t(Direction::None);
+    const uint8_t up = uint8_t(Direction::Up);
+    const uint8_t down = uint8_t(Direction::Down);
+    const uint8_t left = uint8_t(Direction::Left);
+    const uint8_t right = uint8_t(Direction::Right);
+
+    // Steering, as GameState::Steer: take the action unless it is None or
+    // points straight back (Up/Down and Left/Right differ only in bit 0).
+    for (int game = 0; game < gameCount; game++)
+    {
+        uint8_t action = uint8_t(actions[game]);
+        uint8_t current = direction[game];
+        bool take = action != none && action != (current ^ 1);
+        direction[game] = take ? action : current;
+    }
+
+    // Candidate heads and the wall test, branch-free so it vectorises.
+    for (int game = 0; game < gameCount; game++)
+    {
+        uint8_t d = direction[game];
+        int32_t x = headX[game] + (d == right) - (d == left);
+        int32_t y = headY[game] + (d == up) - (d == down);
+        nextX[game] = x;
+        nextY[game] = y;
+        hitWall[game] = (uint32_t(x) >= uint32_t(width)) | (uint32_t(y) >= uint32_t(height));
+    }
+
+    // Self-collision, growth and tail removal need per-game lookups.
+    for (int game = 0; game < gameCount; game++)
+    {
+        done[game] = 0;
+
+        size_t base = size_t(game) * area;
+        int32_t x = nextX[game];
+        int32_t y = nextY[game];
+        int32_t cell = y * width + x;
+
+        // the tail is still marked here, moving into it is a collision
+        if (hitWall[game] || occupancy[base + cell])
+        {
+            done[game] = 1;
+            finalScore[game] = score[game];
+            gamesFinished++;
+            ResetGame(game);
+            continue;
+        }
+
+        // push the head and take its cell out of the free set
+        int32_t first = bodyFirst[game] == 0 ? area - 1 : bodyFirst[game] - 1;
+        bodyFirst[game] = first;
+        body[base + first] = cell;
+        length[game]++;
+        occupancy[base + cell] = 1;
+
+        int32_t slot = freeSlot[base + cell];
+        int32_t last = freeCells[base + freeCount[game] - 1];
+        freeCells[base + slot] = last;
+        freeSlot[base + last] = slot;
+        freeCount[game]--;
+
+        headX[game] = x;
+        headY[game] = y;
+
+        if (x == fruitX[game] && y == fruitY[game])
+        {
+            score[game] += 10;
+            if (freeCount[game] == 0)
+            {
+                done[game] = 1;
+                finalScore[game] = score[game];
+                gamesFinished++;
+                gamesWon++;
+                ResetGame(game);
+                continue;
+            }
+            SpawnFruit(game);
+        }
+        else
+        {
+            int32_t tailIndex = first + length[game] - 1;
+            if (tailIndex >= area)
+            {
+                tailIndex -= area;
+            }
+            int32_t tail = body[base + tailIndex];
+            length[game]--;
+            occupancy[base + tail] = 0;
+
+            freeCells[base + freeCount[game]] = tail;
+            freeSlot[base + tail] = freeCount[game];
+            freeCount[game]++;
+        }
+    }
+
+    steps += gameCount;
+}
+
+void BatchEnv::ResetGame(int game)
+{
+    // Hand the old body back to the free set instead of rebuilding the
+    // whole board, so a restart costs O(length) rather than O(area).
+    size_t base = size_t(game) * area;
+    for (int32_t i = 0; i < length[game]; i++)
+    {
+        int32_t index = bodyFirst[game] + i;
+        int32_t cell = body[base + (index >= area ? index - area : index)];
+        occupancy[base + cell] = 0;
+        freeCells[base + freeCount[game]] = cell;
+        freeSlot[base + cell] = freeCount[game];
+        freeCount[game]++;
+    }
+    length[game] = 0;
+
+    // same start as GameState::Reset, already moving right like Start()
+    int32_t x = width / 4;
+    int32_t y = height / 2;
+    bodyFirst[game] = 0;
+    length[game] = 3;
+    for (int32_t i = 0; i < 3; i++)
+    {
+        int32_t cell = y * width + (x - i);
+        body[base + i] = cell;
+        occupancy[base + cell] = 1;
+
+        int32_t slot = freeSlot[base + cell];
+        int32_t last = freeCells[base + freeCount[game] - 1];
+        freeCells[base + slot] = last;
+        freeSlot[base + last] = slot;
+        freeCount[game]--;
+    }
+
+    headX[game] = x;
+    headY[game] = y;
+    direction[game] = uint8_t(Direction::Right);
+    score[game] = 0;
+    SpawnFruit(game);
+}
+
+void BatchEnv::SpawnFruit(int game)
+{
+    int32_t cell = freeCells[size_t(game) * area + rngs[game].Range(0, freeCount[game] - 1)];
+    fruitX[game] = cell % width;
+    fruitY[game] = cell / width;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Game.h"
+#include "Random.h"
+
+// Steps many independent snake games in lockstep, for training and
+// analysis. State is kept structure-of-arrays, one entry per game, so the
+// per-step work runs as flat loops over contiguous arrays instead of
+// chasing thousands of separate GameState objects. Each game follows the
+// same rules as GameState::Step, starts moving right straight away and is
+// restarted as soon as it ends.
+class BatchEnv
+{
+public:
+    // Game i draws its fruit from stream i of `seed`, so it places fruit
+    // exactly like a GameState seeded with Seed(seed, i) until its first
+    // restart.
+    BatchEnv(int gameCount, int width, int height, uint64_t seed);
+
+    // Applies one action per game (Direction::None keeps going) and steps
+    // every game once. Games that end are recorded in `done` and restarted.
+    void Step(const Direction *actions);
+
+    int Count() const { return gameCount; }
+    int Width() const { return width; }
+    int Height() const { return height; }
+
+    // Per-game state, indexed by game.
+    std::vector<int32_t> headX, headY;
+    std::vector<uint8_t> direction; // a Direction, never None
+    std::vector<int32_t> length;
+    std::vector<int32_t> fruitX, fruitY;
+    std::vector<int32_t> score;
+    std::vector<uint8_t> done;       // ended on the last Step (then restarted)
+    std::vector<int32_t> finalScore; // score of the game that just ended
+
+    unsigned long long steps;         // game steps taken, summed over games
+    unsigned long long gamesFinished; // including wins
+    unsigned long long gamesWon;
+
+private:
+    void ResetGame(int game);
+    void SpawnFruit(int game);
+
+    int gameCount;
+    int width, height, area;
+
+    // Per-game blocks of `area` entries: the occupancy grid, the body as a
+    // ring of cell indices, and the free cells with their position map
+    // (as in FreeCellSet).
+    std::vector<uint8_t> occupancy;
+    std::vector<int32_t> body;
+    std::vector<int32_t> freeCells;
+    std::vector<int32_t> freeSlot;
+    std::vector<int32_t> bodyFirst; // ring index of the head
+    std::vector<int32_t> freeCount;
+
+    // scratch for the new heads of the current step
+    std::vector<int32_t> nextX, nextY;
+    std::vector<uint8_t> hitWall;
+
+    std::vector<Random> rngs; // one stream per game
+};
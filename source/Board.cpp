@@ -0,0 +1,87 @@
+#include "Board.h"
+
+void Board::Resize(int width, int height)
+{
+    this->width = width;
+    this->height = height;
+    freeCells = FreeCellSet(IsDense() ? static_cast<int>(Area()) : 0);
+    Clear();
+}
+
+void Board::Clear()
+{
+    occupiedCount = 0;
+    if (IsDense())
+    {
+        freeCells.Reset();
+    }
+    else
+    {
+        sparse.Reset();
+    }
+}
+
+bool Board::IsOccupied(int x, int y) const
+{
+    if (IsDense())
+    {
+        return !freeCells.Contains(y * width + x);
+    }
+    return sparse.Test(x, y);
+}
+
+void Board::SetOccupied(int x, int y, bool occupied)
+{
+    if (IsDense())
+    {
+        if (occupied)
+        {
+            freeCells.Remove(y * width + x);
+        }
+        else
+        {
+            freeCells.Insert(y * width + x);
+        }
+    }
+    else if (occupied)
+    {
+        sparse.Set(x, y);
+    }
+    else
+    {
+        sparse.Clear(x, y);
+    }
+    occupiedCount += occupied ? 1 : -1;
+}
+
+bool Board::SampleFree(Random &rng, int &x, int &y) const
+{
+    if (occupiedCount >= Area())
+    {
+        return false;
+    }
+
+    if (IsDense())
+    {
+        int cell = freeCells.At(rng.Range(0, freeCells.Count() - 1));
+        x = cell % width;
+        y = cell / width;
+        return true;
+    }
+
+    do
+    {
+        x = rng.Range(0, width - 1);
+        y = rng.Range(0, height - 1);
+    } while (sparse.Test(x, y));
+    return true;
+}
+
+size_t Board::MemoryBytes() const
+{
+    if (IsDense())
+    {
+        return static_cast<size_t>(Area()) * 2 * sizeof(int);
+    }
+    return sparse.MemoryBytes();
+}
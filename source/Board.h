@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "FreeCellSet.h"
+#include "Random.h"
+#include "SparseBoard.h"
+
+// Which cells of a board, sized at launch, are covered by the snake.
+// Boards up to DENSE_CELL_LIMIT cells keep a FreeCellSet, so spawning stays
+// O(1) at any fill level. Larger boards use a SparseBoard whose memory
+// follows the snake, and spawn by rejection sampling, which is cheap there
+// because a snake never covers more than a sliver of such a board.
+class Board
+{
+public:
+    static const int MIN_SIZE = 8;
+    static const int MAX_SIZE = 65536;
+    static const int64_t DENSE_CELL_LIMIT = int64_t(1) << 20;
+
+    Board() : width(0), height(0), occupiedCount(0) {}
+
+    void Resize(int width, int height);
+    void Clear();
+
+    bool IsOccupied(int x, int y) const;
+    void SetOccupied(int x, int y, bool occupied);
+
+    // Picks a uniformly random free cell; false when the board is full.
+    bool SampleFree(Random &rng, int &x, int &y) const;
+
+    int Width() const { return width; }
+    int Height() const { return height; }
+    int64_t Area() const { return int64_t(width) * height; }
+    int64_t OccupiedCount() const { return occupiedCount; }
+    bool IsDense() const { return Area() <= DENSE_CELL_LIMIT; }
+    size_t MemoryBytes() const;
+
+private:
+    int width, height;
+    int64_t occupiedCount;
+    FreeCellSet freeCells; // dense boards only
+    SparseBoard sparse;    // everything else
+};
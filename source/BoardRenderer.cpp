@@ -0,0 +1,360 @@
+#include "BoardRenderer.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace
+{
+// Larger gaps between updates are cheaper to rebuild than to replay.
+const unsigned long long MAX_REPLAYED_MOVES = 64;
+// Fewer changed cells than this go up one texel at a time, more as the
+// rectangle around them.
+const size_t MAX_SINGLE_UPLOADS = 32;
+
+const char *vertexShaderSource = R"(
+#version 330 core
+
+void main()
+{
+    // one triangle over the whole screen
+    vec2 position = vec2((gl_VertexID & 1) * 4 - 1, (gl_VertexID & 2) * 2 - 1);
+    gl_Position = vec4(position, 0.0, 1.0);
+}
+
+)";
+
+// Reproduces what DrawCell's quads would cover, down to the rasterizer's
+// 1/256 pixel rounding of their edges, so both paths give the same image.
+const char *fragmentShaderSource = R"(
+#version 330 core
+uniform usampler2D uCells; // kind, head tick when entered
+uniform vec2 uViewport;
+uniform ivec2 uViewOrigin;
+uniform ivec2 uViewCells;
+uniform ivec2 uGrid;
+uniform uint uHeadStamp;
+uniform float uLength;
+uniform int uMode; // 0 board, 1 board with snake and fruit, 2 game over
+uniform vec3 uBorderColor;
+out vec4 FragColor;
+
+vec2 CellSpan(float index, float cellSize, float halfSize)
+{
+    float centre = -1.0 + index * cellSize + cellSize * 0.5;
+    float size = cellSize * 0.9;
+    vec2 edges = vec2(-0.5 * size + centre, 0.5 * size + centre) * halfSize + halfSize;
+    return roundEven(edges * 256.0) / 256.0;
+}
+
+void main()
+{
+    vec2 cellSize = 2.0 / vec2(uViewCells);
+    vec2 halfSize = uViewport * 0.5;
+    ivec2 index = ivec2(floor(gl_FragCoord.xy / uViewport * vec2(uViewCells)));
+    vec2 spanX = CellSpan(float(index.x), cellSize.x, halfSize.x);
+    vec2 spanY = CellSpan(float(index.y), cellSize.y, halfSize.y);
+    if (gl_FragCoord.x < spanX.x || gl_FragCoord.x >= spanX.y ||
+        gl_FragCoord.y < spanY.x || gl_FragCoord.y >= spanY.y)
+    {
+        discard; // the gap between cells
+    }
+
+    if (uMode == 2)
+    {
+        bool edge = index.x == 0 || index.y == 0 ||
+                    index.x == uViewCells.x - 1 || index.y == uViewCells.y - 1;
+        FragColor = vec4(edge ? uBorderColor : vec3(0.2, 0.1, 0.1), 1.0);
+        return;
+    }
+
+    ivec2 cell = index + uViewOrigin;
+    if (any(lessThan(cell, ivec2(0))) || any(greaterThanEqual(cell, uGrid)))
+    {
+        FragColor = vec4(0.3, 0.3, 0.5, 1.0);
+        return;
+    }
+
+    uvec2 texel = texelFetch(uCells, cell, 0).rg;
+    if (uMode == 1 && texel.r == 1u)
+    {
+        // the head's own cell is left to the sliding head quad
+        uint segment = (uHeadStamp - texel.g) & 0xFFFFu;
+        if (segment != 0u)
+        {
+            float factor = float(segment) / uLength;
+            FragColor = vec4(0.0 * (1.0 - factor) + 0.1 * factor,
+                             0.7 * (1.0 - factor) + 0.1 * factor,
+                             0.1 * (1.0 - factor), 1.0);
+            return;
+        }
+    }
+    if (uMode == 1 && texel.r == 2u)
+    {
+        FragColor = vec4(1.0, 0.3, 0.3, 1.0);
+        return;
+    }
+
+    if ((cell.x + cell.y) % 2 != 0)
+    {
+        discard;
+    }
+    FragColor = vec4(0.082, 0.106, 0.329, 1.0);
+}
+
+)";
+
+GLuint CompileShader(GLenum type, const char *source, const char *name)
+{
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint success;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success)
+    {
+        char infoLog[512];
+        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+        std::cerr << name << " shader error:\n" << infoLog << std::endl;
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+}
+
+BoardRenderer::BoardRenderer()
+    : cellsUploaded(0), fullUploads(0), program(0), VAO(0), texture(0), maxTextureSize(0),
+      width(0), height(0), allocated(false), moves(0), games(0), headStamp(0)
+{
+}
+
+bool BoardRenderer::Init()
+{
+    GLuint vertexShader = CompileShader(GL_VERTEX_SHADER, vertexShaderSource, "Board vertex");
+    GLuint fragmentShader = CompileShader(GL_FRAGMENT_SHADER, fragmentShaderSource, "Board fragment");
+    if (!vertexShader || !fragmentShader)
+    {
+        return false;
+    }
+
+    program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    GLint success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        char infoLog[512];
+        glGetProgramInfoLog(program, 512, nullptr, infoLog);
+        std::cerr << "Board shader link error:\n" << infoLog << std::endl;
+        return false;
+    }
+
+    uniformViewport = glGetUniformLocation(program, "uViewport");
+    uniformViewOrigin = glGetUniformLocation(program, "uViewOrigin");
+    uniformViewCells = glGetUniformLocation(program, "uViewCells");
+    uniformGrid = glGetUniformLocation(program, "uGrid");
+    uniformHeadStamp = glGetUniformLocation(program, "uHeadStamp");
+    uniformLength = glGetUniformLocation(program, "uLength");
+    uniformMode = glGetUniformLocation(program, "uMode");
+    uniformBorderColor = glGetUniformLocation(program, "uBorderColor");
+    glState.UseProgram(program);
+    glState.Uniform1i(glGetUniformLocation(program, "uCells"), 0);
+
+    glGenVertexArrays(1, &VAO);
+    glGenTextures(1, &texture);
+    glState.BindTexture2D(texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+
+    width = height = 0; // the first Update allocates
+    allocated = false;
+    return true;
+}
+
+void BoardRenderer::Shutdown()
+{
+    glState.DeleteTexture(texture);
+    glState.DeleteVertexArray(VAO);
+    glState.DeleteProgram(program);
+    texture = VAO = program = 0;
+    width = height = 0;
+    allocated = false;
+    snake.clear();
+    dirty.clear();
+}
+
+bool BoardRenderer::Update(const GameSnapshot &state)
+{
+    // the texture and its copy here grow with the board, as the quads don't
+    if (state.gridWidth > maxTextureSize || state.gridHeight > maxTextureSize ||
+        int64_t(state.gridWidth) * state.gridHeight > Board::DENSE_CELL_LIMIT ||
+        state.snake.empty() || state.snake.size() > 0xFFFF)
+    {
+        return false;
+    }
+    if (!allocated && state.gridWidth == width && state.gridHeight == height)
+    {
+        return false; // the driver already refused this size
+    }
+
+    unsigned long long moved = state.moves - moves;
+    if (state.gridWidth != width || state.gridHeight != height || state.games != games ||
+        state.moves < moves || moved > MAX_REPLAYED_MOVES || moved >= state.snake.size())
+    {
+        return Rebuild(state);
+    }
+
+    if (!(state.fruit == fruit) && cells[(size_t(fruit.y) * width + fruit.x) * 2] == Fruit)
+    {
+        SetCell(fruit, Empty, 0);
+    }
+
+    // Replay the moves: the tail cells given up, then the new heads from
+    // the oldest. A cell left and re-entered in between ends up as snake.
+    size_t released = snake.size() + moved - state.snake.size();
+    for (size_t i = 0; i < released && !snake.empty(); i++)
+    {
+        SetCell(snake.back(), Empty, 0);
+        snake.pop_back();
+    }
+    for (size_t i = moved; i-- > 0;)
+    {
+        headStamp++;
+        snake.push_front(state.snake[i]);
+        SetCell(state.snake[i], Snake, headStamp);
+    }
+
+    fruit = state.fruit;
+    SetCell(fruit, Fruit, 0);
+    moves = state.moves;
+
+    if (snake.size() != state.snake.size() || !(snake.front() == state.snake.front()) ||
+        !(snake.back() == state.snake.back()))
+    {
+        return Rebuild(state); // out of step, e.g. a missed restart
+    }
+
+    Upload();
+    return true;
+}
+
+bool BoardRenderer::Rebuild(const GameSnapshot &state)
+{
+    // errors from before are not ours to report, only what the uploads add
+    while (glGetError() != GL_NO_ERROR)
+    {
+    }
+
+    glState.BindTexture2D(texture);
+    if (state.gridWidth != width || state.gridHeight != height)
+    {
+        width = state.gridWidth;
+        height = state.gridHeight;
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RG16UI, width, height, 0, GL_RG_INTEGER,
+                     GL_UNSIGNED_SHORT, nullptr);
+        allocated = glGetError() == GL_NO_ERROR;
+        if (!allocated)
+        {
+            std::cerr << "Board texture of " << width << "x" << height
+                      << " not allocated, drawing cells instead" << std::endl;
+            return false;
+        }
+    }
+
+    cells.assign(size_t(width) * height * 2, 0);
+    snake.assign(state.snake.begin(), state.snake.end());
+    for (size_t i = 0; i < snake.size(); i++)
+    {
+        size_t texel = (size_t(snake[i].y) * width + snake[i].x) * 2;
+        cells[texel] = Snake;
+        cells[texel + 1] = static_cast<uint16_t>(headStamp - i);
+    }
+    fruit = state.fruit;
+    cells[(size_t(fruit.y) * width + fruit.x) * 2] = Fruit;
+    moves = state.moves;
+    games = state.games;
+
+    glState.PixelStore(GL_UNPACK_ALIGNMENT, 4);
+    glState.PixelStore(GL_UNPACK_ROW_LENGTH, 0);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RG_INTEGER, GL_UNSIGNED_SHORT,
+                    cells.data());
+
+    dirty.clear();
+    cellsUploaded += size_t(width) * height;
+    fullUploads++;
+    if (glGetError() != GL_NO_ERROR)
+    {
+        width = height = 0; // unknown contents, rebuilt from scratch next time
+        return false;
+    }
+    return true;
+}
+
+void BoardRenderer::SetCell(const vec2i &cell, Kind kind, uint16_t stamp)
+{
+    size_t texel = (size_t(cell.y) * width + cell.x) * 2;
+    cells[texel] = kind;
+    cells[texel + 1] = stamp;
+    dirty.push_back(cell);
+}
+
+void BoardRenderer::Upload()
+{
+    if (dirty.empty())
+    {
+        return;
+    }
+
+    glState.BindTexture2D(texture);
+    glState.PixelStore(GL_UNPACK_ALIGNMENT, 4);
+    if (dirty.size() <= MAX_SINGLE_UPLOADS)
+    {
+        for (const vec2i &cell : dirty)
+        {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, cell.x, cell.y, 1, 1, GL_RG_INTEGER, GL_UNSIGNED_SHORT,
+                            &cells[(size_t(cell.y) * width + cell.x) * 2]);
+        }
+        cellsUploaded += dirty.size();
+    }
+    else
+    {
+        vec2i low = dirty[0], high = dirty[0];
+        for (const vec2i &cell : dirty)
+        {
+            low = vec2i(std::min(low.x, cell.x), std::min(low.y, cell.y));
+            high = vec2i(std::max(high.x, cell.x), std::max(high.y, cell.y));
+        }
+        int rectWidth = high.x - low.x + 1;
+        int rectHeight = high.y - low.y + 1;
+        glState.PixelStore(GL_UNPACK_ROW_LENGTH, width);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, low.x, low.y, rectWidth, rectHeight, GL_RG_INTEGER,
+                        GL_UNSIGNED_SHORT, &cells[(size_t(low.y) * width + low.x) * 2]);
+        cellsUploaded += size_t(rectWidth) * rectHeight;
+    }
+    dirty.clear();
+}
+
+void BoardRenderer::Draw(const vec2i &viewOrigin, int viewWidth, int viewHeight, int framebufferWidth,
+                         int framebufferHeight, bool pieces, bool gameOver, const float borderColor[3])
+{
+    glState.UseProgram(program);
+    glState.Uniform2f(uniformViewport, float(framebufferWidth), float(framebufferHeight));
+    glState.Uniform2i(uniformViewOrigin, viewOrigin.x, viewOrigin.y);
+    glState.Uniform2i(uniformViewCells, viewWidth, viewHeight);
+    glState.Uniform2i(uniformGrid, width, height);
+    glState.Uniform1ui(uniformHeadStamp, headStamp);
+    glState.Uniform1f(uniformLength, float(snake.size()));
+    glState.Uniform1i(uniformMode, gameOver ? 2 : pieces ? 1 : 0);
+    glState.Uniform3fv(uniformBorderColor, borderColor);
+
+    glState.BindTexture2D(texture);
+    glState.BindVertexArray(VAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "GLStateCache.h"
+#include "Game.h"
+
+// Draws the board, the snake's body and the fruit in one full-screen
+// fragment-shader pass over a texture with one texel per board cell,
+// instead of a quad per cell. Each texel holds what is in the cell (empty,
+// snake, fruit) and, for the snake, the tick its head entered the cell; the
+// shader turns the gap to the head's tick into the body gradient. Checker
+// and border cells follow from the coordinates.
+//
+// Between frames only the cells that changed are uploaded: the new head
+// cells, the tail cells left behind and the fruit. Frame cost does not
+// grow with the snake or the board. The sliding head and tail ends are not
+// included, they are drawn as quads on top.
+class BoardRenderer
+{
+public:
+    BoardRenderer();
+
+    // Needs a current GL 3.3 context; false if the shaders fail to build.
+    bool Init();
+    void Shutdown();
+
+    // Brings the texture up to date with `state`. False if the board is
+    // too big for a texture (more than Board::DENSE_CELL_LIMIT cells, or
+    // more than the driver gives), or the snake too long for its tick
+    // stamps; the caller then has to draw cells itself.
+    bool Update(const GameSnapshot &state);
+
+    // Shades the visible window of the board: viewWidth x viewHeight cells
+    // from viewOrigin, each 90% of its slot as in DrawCell. With
+    // `pieces` the snake body and fruit are drawn; with `gameOver` the
+    // game-over board instead, its edge in borderColor.
+    void Draw(const vec2i &viewOrigin, int viewWidth, int viewHeight, int framebufferWidth,
+              int framebufferHeight, bool pieces, bool gameOver, const float borderColor[3]);
+
+    unsigned long long cellsUploaded; // texels written, over the whole run
+    unsigned long long fullUploads;   // whole-texture rebuilds
+
+private:
+    enum Kind : uint16_t
+    {
+        Empty = 0,
+        Snake = 1,
+        Fruit = 2
+    };
+
+    bool Rebuild(const GameSnapshot &state);
+    void SetCell(const vec2i &cell, Kind kind, uint16_t stamp);
+    void Upload();
+
+    GLuint program;
+    GLuint VAO; // empty, the triangle comes from gl_VertexID
+    GLuint texture;
+    GLint maxTextureSize;
+    GLint uniformViewport, uniformViewOrigin, uniformViewCells, uniformGrid;
+    GLint uniformHeadStamp, uniformLength, uniformMode, uniformBorderColor;
+
+    // what the texture holds, two values per cell as in the texture
+    int width, height;
+    bool allocated; // the texture has room for width x height
+    std::vector<uint16_t> cells;
+    std::deque<vec2i> snake; // the snake the texture shows, [0] is the head
+    vec2i fruit;
+    unsigned long long moves, games; // of the snapshot last applied
+    uint16_t headStamp;              // the head's tick, wrapping
+    std::vector<vec2i> dirty; // cells changed since the last upload
+};
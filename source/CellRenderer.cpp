@@ -0,0 +1,309 @@
+#include "CellRenderer.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+
+namespace
+{
+const size_t INITIAL_STREAM_BYTES = 1 << 16; // grown by StreamBuffer if needed
+
+const char *vertexShaderSource = R"(
+#version 330 core
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec4 aRect; // centre xy, size zw
+layout (location = 2) in vec3 aColor;
+
+out vec3 vColor;
+
+void main()
+{
+    vec2 position = (aPos * aRect.zw) + aRect.xy;
+    gl_Position = vec4(position, 0.0, 1.0);
+    vColor = aColor;
+}
+
+)";
+
+const char *fragmentShaderSource = R"(
+#version 330 core
+in vec3 vColor;
+out vec4 FragColor;
+
+void main()
+{
+    FragColor = vec4(vColor, 1.0);
+}
+
+)";
+
+GLuint CompileShader(GLenum type, const char *source, const char *name)
+{
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint success;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success)
+    {
+        char infoLog[512];
+        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+        std::cerr << name << " shader error:\n" << infoLog << std::endl;
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+}
+
+CellRenderer::CellRenderer()
+    : damagedPixels(0), framePixels(0), emptyFrames(0), program(0), quadVBO(0), VAO(0), viewportWidth(0),
+      viewportHeight(0), backgroundVAO(0), backgroundVBO(0),
+      backgroundCount(0), retained(false), framebuffer(0), colorBuffer(0), outputFramebuffer(0),
+      fullDamage(true), clearPending(false), clearColor()
+{
+}
+
+bool CellRenderer::Init(bool persistentMapping, bool retain)
+{
+    retained = retain;
+    GLuint vertexShader = CompileShader(GL_VERTEX_SHADER, vertexShaderSource, "Vertex");
+    GLuint fragmentShader = CompileShader(GL_FRAGMENT_SHADER, fragmentShaderSource, "Fragment");
+    if (!vertexShader || !fragmentShader)
+    {
+        return false;
+    }
+
+    program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    GLint success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        char infoLog[512];
+        glGetProgramInfoLog(program, 512, nullptr, infoLog);
+        std::cerr << "Shader link error:\n" << infoLog << std::endl;
+        return false;
+    }
+
+    float vertices[] = {
+        -0.5f, -0.5f,
+        0.5f,  -0.5f,
+        -0.5f,  0.5f,
+        0.5f,   0.5f,
+    };
+
+    glGenBuffers(1, &quadVBO);
+    glState.BindArrayBuffer(quadVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+    stream.Init(INITIAL_STREAM_BYTES, persistentMapping);
+    glGenBuffers(1, &backgroundVBO);
+    VAO = CreateInstanceVAO(stream.Buffer());
+    backgroundVAO = CreateInstanceVAO(backgroundVBO);
+    return true;
+}
+
+GLuint CellRenderer::CreateInstanceVAO(GLuint instanceBuffer)
+{
+    GLuint vao;
+    glGenVertexArrays(1, &vao);
+    glState.BindVertexArray(vao);
+
+    glState.VertexAttribPointer(0, quadVBO, 2, GL_FLOAT, 2 * sizeof(float), 0);
+    glEnableVertexAttribArray(0);
+
+    // per-instance rect and colour, advanced once per quad
+    glState.VertexAttribPointer(1, instanceBuffer, 4, GL_FLOAT, sizeof(CellInstance), offsetof(CellInstance, x));
+    glState.VertexAttribPointer(2, instanceBuffer, 3, GL_FLOAT, sizeof(CellInstance), offsetof(CellInstance, r));
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(1, 1);
+    glVertexAttribDivisor(2, 1);
+    return vao;
+}
+
+void CellRenderer::Shutdown()
+{
+    glState.DeleteVertexArray(VAO);
+    glState.DeleteVertexArray(backgroundVAO);
+    glState.DeleteBuffer(quadVBO);
+    glState.DeleteBuffer(backgroundVBO);
+    glState.DeleteProgram(program);
+    stream.Shutdown();
+    if (framebuffer)
+    {
+        glState.DeleteFramebuffer(framebuffer);
+        glDeleteRenderbuffers(1, &colorBuffer);
+    }
+    framebuffer = colorBuffer = 0;
+    VAO = backgroundVAO = quadVBO = backgroundVBO = program = 0;
+    backgroundCount = 0;
+    viewportWidth = viewportHeight = 0;
+}
+
+bool CellRenderer::BeginFrame(int width, int height, float r, float g, float b)
+{
+    bool resized = width != viewportWidth || height != viewportHeight;
+    if (resized)
+    {
+        viewportWidth = width;
+        viewportHeight = height;
+    }
+    glState.Viewport(0, 0, viewportWidth, viewportHeight);
+    damage.clear();
+    fullDamage = true;
+
+    if (retained)
+    {
+        // the clear waits for SetDamage to say where. The output is asked of
+        // GL, as the caller binds it without the state cache.
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &outputFramebuffer);
+        if (resized || !framebuffer)
+        {
+            if (!framebuffer)
+            {
+                glGenFramebuffers(1, &framebuffer);
+                glGenRenderbuffers(1, &colorBuffer);
+            }
+            glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+            glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+            glState.BindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+            glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+        }
+        glState.BindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        clearColor[0] = r;
+        clearColor[1] = g;
+        clearColor[2] = b;
+        clearPending = true;
+        framePixels += (unsigned long long)width * height;
+        return resized;
+    }
+
+    glState.ClearColor(r, g, b, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    return resized;
+}
+
+void CellRenderer::SetDamage(const std::vector<Rect> &rects)
+{
+    if (!retained)
+    {
+        return;
+    }
+
+    fullDamage = false;
+    damage.clear();
+    for (Rect rect : rects)
+    {
+        int right = std::min(rect.x + rect.width, viewportWidth);
+        int top = std::min(rect.y + rect.height, viewportHeight);
+        rect.x = std::max(rect.x, 0);
+        rect.y = std::max(rect.y, 0);
+        rect.width = right - rect.x;
+        rect.height = top - rect.y;
+        if (rect.width > 0 && rect.height > 0)
+        {
+            damage.push_back(rect);
+        }
+    }
+}
+
+// BeginFrame's clear, over just the damage once it is known.
+void CellRenderer::ClearDamage()
+{
+    if (!clearPending)
+    {
+        return;
+    }
+    clearPending = false;
+
+    glState.ClearColor(clearColor[0], clearColor[1], clearColor[2], 1.0f);
+    glState.ScissorTest(!fullDamage);
+    if (fullDamage)
+    {
+        glClear(GL_COLOR_BUFFER_BIT);
+        damagedPixels += (unsigned long long)viewportWidth * viewportHeight;
+        return;
+    }
+    for (const Rect &rect : damage)
+    {
+        glState.Scissor(rect.x, rect.y, rect.width, rect.height);
+        glClear(GL_COLOR_BUFFER_BIT);
+        damagedPixels += (unsigned long long)rect.width * rect.height;
+    }
+    emptyFrames += damage.empty();
+}
+
+void CellRenderer::Flush()
+{
+    if (queued.empty() || (!fullDamage && damage.empty()))
+    {
+        queued.clear();
+        return;
+    }
+
+    size_t offset = stream.Upload(queued.data(), queued.size() * sizeof(CellInstance));
+
+    // without base-instance draws the attributes are pointed at this
+    // frame's region instead, unless they already are
+    glState.UseProgram(program);
+    glState.BindVertexArray(VAO);
+    glState.VertexAttribPointer(1, stream.Buffer(), 4, GL_FLOAT, sizeof(CellInstance),
+                                offset + offsetof(CellInstance, x));
+    glState.VertexAttribPointer(2, stream.Buffer(), 3, GL_FLOAT, sizeof(CellInstance),
+                                offset + offsetof(CellInstance, r));
+    GLsizei count = static_cast<GLsizei>(queued.size());
+    ForEachDamageRect([count] { glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, count); });
+
+    drawCalls++;
+    instances += queued.size();
+    queued.clear();
+}
+
+void CellRenderer::EndFrame()
+{
+    if (retained)
+    {
+        ClearDamage();
+        glState.ScissorTest(false); // the copy is scissored too
+        glState.BindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+        glState.BindFramebuffer(GL_DRAW_FRAMEBUFFER, outputFramebuffer);
+        glBlitFramebuffer(0, 0, viewportWidth, viewportHeight, 0, 0, viewportWidth, viewportHeight,
+                          GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        glState.BindFramebuffer(GL_FRAMEBUFFER, outputFramebuffer);
+    }
+    stream.EndFrame();
+}
+
+void CellRenderer::StoreBackground()
+{
+    glState.BindArrayBuffer(backgroundVBO);
+    glBufferData(GL_ARRAY_BUFFER, queued.size() * sizeof(CellInstance), queued.data(), GL_STATIC_DRAW);
+
+    backgroundCount = static_cast<GLsizei>(queued.size());
+    backgroundBuilds++;
+    queued.clear();
+}
+
+void CellRenderer::DrawBackground()
+{
+    if (backgroundCount == 0 || (!fullDamage && damage.empty()))
+    {
+        return;
+    }
+
+    glState.UseProgram(program);
+    glState.BindVertexArray(backgroundVAO);
+    GLsizei count = backgroundCount;
+    ForEachDamageRect([count] { glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, count); });
+
+    drawCalls++;
+    instances += backgroundCount;
+}
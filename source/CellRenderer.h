@@ -0,0 +1,92 @@
+#pragma once
+
+#include <vector>
+
+#include "GLStateCache.h"
+#include "RenderBackend.h"
+#include "StreamBuffer.h"
+
+// The GL backend: draws every quad of a frame with a single instanced call.
+// Flush uploads the queued cells to one instance buffer and draws them on
+// top of a shared unit quad, instead of three uniform updates and a draw
+// per cell. The background layer stays on the GPU and costs one draw per
+// frame without any upload.
+//
+// Retained, the frame is drawn into a framebuffer of the renderer's own
+// that keeps its contents from one frame to the next. Only the rectangles
+// given to SetDamage are cleared and drawn again, with the scissor on
+// each, and EndFrame copies the whole image to the framebuffer that was
+// bound at BeginFrame.
+class CellRenderer : public RenderBackend
+{
+public:
+    // In pixels, from the bottom left like glScissor.
+    struct Rect
+    {
+        int x, y, width, height;
+    };
+
+    CellRenderer();
+
+    // Needs a current GL 3.3 context; false if the shaders fail to build.
+    // Per-frame instances stream through a persistently mapped ring when
+    // the driver has buffer storage, unless persistentMapping is false.
+    bool Init(bool persistentMapping = true, bool retained = false);
+    void Shutdown();
+
+    bool Retained() const { return retained; }
+    // Limits the frame begun last to `rects`; none at all leaves the last
+    // frame as it was. Call before anything is drawn. Without a call the
+    // whole frame is damaged, as it always is when not retained.
+    void SetDamage(const std::vector<Rect> &rects);
+    // Calls `draw` once for each damaged rectangle with the scissor set to
+    // it, for drawing around the queue, e.g. another shader's pass.
+    template <class Draw> void ForEachDamageRect(Draw draw);
+
+    bool BeginFrame(int width, int height, float r, float g, float b) override;
+    void Flush() override;
+    void EndFrame() override;
+    void StoreBackground() override;
+    void DrawBackground() override;
+
+    StreamBuffer stream; // per-frame instances, read for its stats
+
+    unsigned long long damagedPixels; // cleared and drawn again, over the whole run
+    unsigned long long framePixels;   // in all the frames retained so far
+    unsigned long long emptyFrames;   // retained frames that drew nothing
+
+private:
+    GLuint CreateInstanceVAO(GLuint instanceBuffer);
+    void ClearDamage();
+
+    GLuint program;
+    GLuint quadVBO;
+    GLuint VAO; // instances come from stream, re-pointed every Flush
+    int viewportWidth, viewportHeight;
+
+    GLuint backgroundVAO, backgroundVBO;
+    GLsizei backgroundCount;
+
+    bool retained;
+    GLuint framebuffer, colorBuffer;
+    GLint outputFramebuffer; // bound at BeginFrame, gets the finished frame
+    std::vector<Rect> damage;
+    bool fullDamage;
+    bool clearPending; // BeginFrame's clear, done with the first draw
+    float clearColor[3];
+};
+
+template <class Draw> void CellRenderer::ForEachDamageRect(Draw draw)
+{
+    ClearDamage();
+    if (fullDamage)
+    {
+        draw();
+        return;
+    }
+    for (const Rect &rect : damage)
+    {
+        glState.Scissor(rect.x, rect.y, rect.width, rect.height);
+        draw();
+    }
+}
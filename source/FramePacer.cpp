@@ -0,0 +1,45 @@
+#include "FramePacer.h"
+
+#include <thread>
+
+namespace
+{
+// covers the usual sleep overshoot, the remainder is spun
+const std::chrono::microseconds SPIN_TIME(1500);
+}
+
+FramePacer::FramePacer(double fps)
+{
+    SetTargetFps(fps);
+}
+
+void FramePacer::SetTargetFps(double fps)
+{
+    period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / fps));
+    next = Clock::now() + period;
+}
+
+double FramePacer::TargetFps() const
+{
+    return 1.0 / std::chrono::duration<double>(period).count();
+}
+
+void FramePacer::Wait()
+{
+    Clock::time_point now = Clock::now();
+    if (now - next > period)
+    {
+        next = now + period; // fell more than a frame behind, start over
+        return;
+    }
+
+    if (next - now > SPIN_TIME)
+    {
+        std::this_thread::sleep_for(next - now - SPIN_TIME);
+    }
+    while (Clock::now() < next)
+    {
+        std::this_thread::yield();
+    }
+    next += period;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <chrono>
+
+// Holds the main loop to a target frame rate. Sleeping alone overshoots by
+// the scheduler's granularity and spinning alone burns a core, so Wait
+// sleeps until shortly before the deadline and spins only the rest.
+class FramePacer
+{
+public:
+    explicit FramePacer(double fps = 60.0);
+
+    void SetTargetFps(double fps);
+    double TargetFps() const;
+
+    // Blocks until the next frame is due. Deadlines advance by whole
+    // periods, so a slightly late frame is caught up without drift, while
+    // a long stall restarts the schedule instead of bursting to catch up.
+    void Wait();
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    Clock::duration period;
+    Clock::time_point next;
+};
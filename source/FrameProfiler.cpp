@@ -0,0 +1,185 @@
+#include "FrameProfiler.h"
+
+namespace
+{
+float MillisecondsSince(std::chrono::steady_clock::time_point start,
+                        std::chrono::steady_clock::time_point end)
+{
+    return std::chrono::duration<float, std::milli>(end - start).count();
+}
+}
+
+FrameProfiler::FrameProfiler()
+    : frame(0), open(false), gpuFrame(false), nextPhase(0), gpuTimer(false), queries(),
+      queryFrame(), queryPending()
+{
+}
+
+bool FrameProfiler::Init()
+{
+    GLint bits = 0;
+    if (glQueryCounter && glGetQueryObjectui64v)
+    {
+        glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &bits);
+    }
+    gpuTimer = bits > 0;
+    if (gpuTimer)
+    {
+        glGenQueries(QUERY_FRAMES * (PHASE_COUNT + 1), &queries[0][0]);
+    }
+    return gpuTimer;
+}
+
+void FrameProfiler::Shutdown()
+{
+    if (gpuTimer)
+    {
+        glDeleteQueries(QUERY_FRAMES * (PHASE_COUNT + 1), &queries[0][0]);
+    }
+    gpuTimer = false;
+    Reset();
+}
+
+void FrameProfiler::Reset()
+{
+    frame = 0;
+    open = false;
+    for (bool &pending : queryPending)
+    {
+        pending = false;
+    }
+}
+
+void FrameProfiler::BeginFrame(bool gpu)
+{
+    if (open)
+    {
+        EndFrame(); // never presented, e.g. offscreen
+    }
+    Collect();
+
+    auto now = std::chrono::steady_clock::now();
+    Sample &sample = history[frame % HISTORY];
+    sample = Sample();
+    if (frame > 0)
+    {
+        sample.frameMs = MillisecondsSince(frameStart, now);
+    }
+    frameStart = phaseStart = now;
+    nextPhase = 0;
+    open = true;
+
+    // a set still pending from QUERY_FRAMES frames ago is given up on
+    gpuFrame = gpu && gpuTimer;
+    if (gpuFrame)
+    {
+        int set = frame % QUERY_FRAMES;
+        queryPending[set] = false;
+        queryFrame[set] = frame;
+        glQueryCounter(queries[set][0], GL_TIMESTAMP);
+    }
+}
+
+void FrameProfiler::Mark(Phase phase)
+{
+    if (!open)
+    {
+        return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    Sample &sample = history[frame % HISTORY];
+    for (; nextPhase <= phase; nextPhase++)
+    {
+        // phases skipped over take no time
+        sample.cpuMs[nextPhase] = nextPhase == phase ? MillisecondsSince(phaseStart, now) : 0.0f;
+        if (gpuFrame)
+        {
+            glQueryCounter(queries[frame % QUERY_FRAMES][nextPhase + 1], GL_TIMESTAMP);
+        }
+    }
+    phaseStart = now;
+}
+
+void FrameProfiler::Count(unsigned long long drawCalls, unsigned long long cells,
+                          unsigned long long stateCalls, unsigned long long stateElided)
+{
+    Sample &sample = history[frame % HISTORY];
+    sample.drawCalls = static_cast<unsigned>(drawCalls);
+    sample.cells = static_cast<unsigned>(cells);
+    sample.stateCalls = static_cast<unsigned>(stateCalls);
+    sample.stateElided = static_cast<unsigned>(stateElided);
+}
+
+void FrameProfiler::EndFrame()
+{
+    if (!open)
+    {
+        return;
+    }
+
+    // unmarked phases end here without taking any time
+    Sample &sample = history[frame % HISTORY];
+    for (; nextPhase < PHASE_COUNT; nextPhase++)
+    {
+        sample.cpuMs[nextPhase] = 0.0f;
+        if (gpuFrame)
+        {
+            glQueryCounter(queries[frame % QUERY_FRAMES][nextPhase + 1], GL_TIMESTAMP);
+        }
+    }
+
+    if (gpuFrame)
+    {
+        queryPending[frame % QUERY_FRAMES] = true;
+    }
+    open = false;
+    frame++;
+}
+
+// Reads back every query set that has finished, without waiting for any.
+void FrameProfiler::Collect()
+{
+    for (int set = 0; set < QUERY_FRAMES; set++)
+    {
+        if (!queryPending[set])
+        {
+            continue;
+        }
+
+        // timestamps complete in order, so the last one answers for all
+        GLint available = 0;
+        glGetQueryObjectiv(queries[set][PHASE_COUNT], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+        {
+            continue;
+        }
+        queryPending[set] = false;
+        if (frame - queryFrame[set] >= HISTORY)
+        {
+            continue; // its slot has been reused
+        }
+
+        GLuint64 stamps[PHASE_COUNT + 1];
+        for (int i = 0; i <= PHASE_COUNT; i++)
+        {
+            glGetQueryObjectui64v(queries[set][i], GL_QUERY_RESULT, &stamps[i]);
+        }
+        Sample &sample = history[queryFrame[set] % HISTORY];
+        for (int phase = 0; phase < PHASE_COUNT; phase++)
+        {
+            sample.gpuMs[phase] = (stamps[phase + 1] - stamps[phase]) / 1e6f;
+        }
+        sample.hasGpu = true;
+    }
+}
+
+bool FrameProfiler::Get(int age, Sample &sample) const
+{
+    if (age < 0 || age >= HISTORY || static_cast<unsigned long long>(age) >= frame)
+    {
+        return false;
+    }
+    sample = history[(frame - 1 - age) % HISTORY];
+    return true;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <chrono>
+
+#include "GLExtensions.h"
+
+// Where a frame's time goes, phase by phase, on the CPU and, with the GL
+// backend, on the GPU. GPU times come from timestamp queries that are read
+// back frames later and only once the driver says they are ready, so
+// profiling never stalls the pipeline. A frame whose results are not back
+// by the time its query set comes round again keeps no GPU time.
+class FrameProfiler
+{
+public:
+    enum Phase
+    {
+        Border, // clear, background layer, game-over board
+        Snake,
+        Text,   // score and screens, plus the overlay itself
+        Swap,   // from the end of RenderGame until the frame is presented
+        PHASE_COUNT
+    };
+
+    static const int HISTORY = 120;    // frames kept for the overlay graphs
+    static const int QUERY_FRAMES = 4; // query sets in flight, one per frame
+
+    struct Sample
+    {
+        float frameMs = 0.0f; // since the previous frame began
+        float cpuMs[PHASE_COUNT] = {};
+        float gpuMs[PHASE_COUNT] = {};
+        bool hasGpu = false; // gpuMs is valid, once the queries came back
+        unsigned drawCalls = 0, cells = 0;
+        unsigned stateCalls = 0, stateElided = 0; // through the GL state cache
+    };
+
+    FrameProfiler();
+
+    // Needs a current GL context. False if it cannot time the GPU, in which
+    // case only CPU times are kept.
+    bool Init();
+    void Shutdown();
+    // Forgets every frame so far, e.g. after a pause in profiling.
+    void Reset();
+
+    // Starts a frame, timing the GPU as well if `gpu`.
+    void BeginFrame(bool gpu);
+    // Ends `phase` here; the next phase starts at the same point.
+    void Mark(Phase phase);
+    void Count(unsigned long long drawCalls, unsigned long long cells, unsigned long long stateCalls,
+               unsigned long long stateElided);
+    // Closes the frame; phases never marked keep zero time.
+    void EndFrame();
+
+    // age 0 is the last finished frame. False for frames not recorded yet.
+    bool Get(int age, Sample &sample) const;
+    // Frames recorded since the start.
+    unsigned long long Frames() const { return frame; }
+
+private:
+    void Collect();
+
+    Sample history[HISTORY];
+    unsigned long long frame; // frames finished so far
+    bool open;                // BeginFrame without EndFrame
+    bool gpuFrame;            // the open frame issued queries
+    int nextPhase;            // the phase the next Mark ends
+    std::chrono::steady_clock::time_point frameStart, phaseStart;
+
+    bool gpuTimer;
+    GLuint queries[QUERY_FRAMES][PHASE_COUNT + 1]; // a timestamp at every phase boundary
+    unsigned long long queryFrame[QUERY_FRAMES];   // frame each set was issued for
+    bool queryPending[QUERY_FRAMES];
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cassert>
+#include <vector>
+
+// Set of free board cells (by cell index) that supports O(1) insert,
+// remove, membership and uniform sampling at any fill level. Free cells
+// are packed at the front of `cells`; `slot` maps a cell back to its
+// position there, or NOT_FREE when the cell is taken. Removal swaps the
+// last free cell into the hole.
+class FreeCellSet
+{
+public:
+    static const int NOT_FREE = -1;
+
+    explicit FreeCellSet(int cellCount = 0)
+        : cells(cellCount), slot(cellCount), count(0)
+    {
+        Reset();
+    }
+
+    // Marks every cell free again.
+    void Reset()
+    {
+        count = static_cast<int>(cells.size());
+        for (int i = 0; i < count; i++)
+        {
+            cells[i] = i;
+            slot[i] = i;
+        }
+    }
+
+    void Remove(int cell)
+    {
+        int index = slot[cell];
+        assert(index != NOT_FREE);
+
+        int last = cells[count - 1];
+        cells[index] = last;
+        slot[last] = index;
+        slot[cell] = NOT_FREE;
+        count--;
+    }
+
+    void Insert(int cell)
+    {
+        assert(slot[cell] == NOT_FREE);
+        cells[count] = cell;
+        slot[cell] = count;
+        count++;
+    }
+
+    bool Contains(int cell) const { return slot[cell] != NOT_FREE; }
+
+    // The i-th free cell, for i in [0, Count()). Order is arbitrary.
+    int At(int i) const { return cells[i]; }
+
+    int Count() const { return count; }
+    bool Empty() const { return count == 0; }
+
+private:
+    std::vector<int> cells;
+    std::vector<int> slot;
+    int count;
+};
@@ -0,0 +1,47 @@
+#include "GLExtensions.h"
+
+#include <cstring>
+
+PFNGLVERTEXATTRIBDIVISORPROC glVertexAttribDivisor = nullptr;
+PFNGLDRAWARRAYSINSTANCEDPROC glDrawArraysInstanced = nullptr;
+PFNGLFENCESYNCPROC glFenceSync = nullptr;
+PFNGLCLIENTWAITSYNCPROC glClientWaitSync = nullptr;
+PFNGLDELETESYNCPROC glDeleteSync = nullptr;
+PFNGLBUFFERSTORAGEPROC glBufferStorage = nullptr;
+PFNGLQUERYCOUNTERPROC glQueryCounter = nullptr;
+PFNGLGETQUERYOBJECTUI64VPROC glGetQueryObjectui64v = nullptr;
+
+bool LoadGLExtensions(GLADloadproc load)
+{
+    glVertexAttribDivisor = (PFNGLVERTEXATTRIBDIVISORPROC)load("glVertexAttribDivisor");
+    glDrawArraysInstanced = (PFNGLDRAWARRAYSINSTANCEDPROC)load("glDrawArraysInstanced");
+    glFenceSync = (PFNGLFENCESYNCPROC)load("glFenceSync");
+    glClientWaitSync = (PFNGLCLIENTWAITSYNCPROC)load("glClientWaitSync");
+    glDeleteSync = (PFNGLDELETESYNCPROC)load("glDeleteSync");
+    glQueryCounter = (PFNGLQUERYCOUNTERPROC)load("glQueryCounter");
+    glGetQueryObjectui64v = (PFNGLGETQUERYOBJECTUI64VPROC)load("glGetQueryObjectui64v");
+
+    // loaders hand out pointers for entry points the context does not
+    // support, so only trust this one when the version or extension says so
+    bool storage = GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 4) ||
+                   HasGLExtension("GL_ARB_buffer_storage");
+    glBufferStorage = storage ? (PFNGLBUFFERSTORAGEPROC)load("glBufferStorage") : nullptr;
+
+    return glVertexAttribDivisor && glDrawArraysInstanced && glFenceSync && glClientWaitSync &&
+           glDeleteSync;
+}
+
+bool HasGLExtension(const char *name)
+{
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; i++)
+    {
+        const char *extension = (const char *)glGetStringi(GL_EXTENSIONS, i);
+        if (extension && std::strcmp(extension, name) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// Entry points newer than the GL 3.0 that thirdparty/glad was generated
+// for. Call LoadGLExtensions after gladLoadGLLoader, with the same loader.
+
+#define GL_SYNC_FLUSH_COMMANDS_BIT 0x00000001
+#define GL_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+#define GL_ALREADY_SIGNALED 0x911A
+#define GL_TIMEOUT_EXPIRED 0x911B
+#define GL_CONDITION_SATISFIED 0x911C
+#define GL_WAIT_FAILED 0x911D
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#define GL_MAP_COHERENT_BIT 0x0080
+#define GL_TIMESTAMP 0x8E28
+
+typedef void (APIENTRYP PFNGLVERTEXATTRIBDIVISORPROC)(GLuint index, GLuint divisor);
+typedef void (APIENTRYP PFNGLDRAWARRAYSINSTANCEDPROC)(GLenum mode, GLint first, GLsizei count,
+                                                      GLsizei instancecount);
+typedef GLsync (APIENTRYP PFNGLFENCESYNCPROC)(GLenum condition, GLbitfield flags);
+typedef GLenum (APIENTRYP PFNGLCLIENTWAITSYNCPROC)(GLsync sync, GLbitfield flags, GLuint64 timeout);
+typedef void (APIENTRYP PFNGLDELETESYNCPROC)(GLsync sync);
+typedef void (APIENTRYP PFNGLBUFFERSTORAGEPROC)(GLenum target, GLsizeiptr size, const void *data,
+                                                GLbitfield flags);
+typedef void (APIENTRYP PFNGLQUERYCOUNTERPROC)(GLuint id, GLenum target);
+typedef void (APIENTRYP PFNGLGETQUERYOBJECTUI64VPROC)(GLuint id, GLenum pname, GLuint64 *params);
+
+extern PFNGLVERTEXATTRIBDIVISORPROC glVertexAttribDivisor;   // GL 3.3
+extern PFNGLDRAWARRAYSINSTANCEDPROC glDrawArraysInstanced; // GL 3.1
+extern PFNGLFENCESYNCPROC glFenceSync;                     // GL 3.2
+extern PFNGLCLIENTWAITSYNCPROC glClientWaitSync;           // GL 3.2
+extern PFNGLDELETESYNCPROC glDeleteSync;                   // GL 3.2
+
+// Optional, null unless the context is GL 4.4 or has ARB_buffer_storage.
+extern PFNGLBUFFERSTORAGEPROC glBufferStorage;
+
+// Timer queries, GL 3.3 but only used for profiling; null if missing.
+extern PFNGLQUERYCOUNTERPROC glQueryCounter;
+extern PFNGLGETQUERYOBJECTUI64VPROC glGetQueryObjectui64v;
+
+// False if the driver is missing any of the required ones.
+bool LoadGLExtensions(GLADloadproc load);
+
+// Whether the current context advertises the named extension.
+bool HasGLExtension(const char *name);
@@ -0,0 +1,285 @@
+#include "GLStateCache.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+const GLuint UNKNOWN = ~0u; // a binding not seen since the last Reset
+}
+
+GLStateCache glState;
+
+GLStateCache::GLStateCache()
+    : issued(0), elided(0)
+{
+    Reset();
+}
+
+void GLStateCache::Reset()
+{
+    program = vao = arrayBuffer = texture = scissorTest = UNKNOWN;
+    drawFramebuffer = readFramebuffer = UNKNOWN;
+    viewportKnown = scissorKnown = clearColorKnown = false;
+    pixelStore.clear();
+    uniforms.clear();
+    attributes.clear();
+}
+
+bool GLStateCache::Changed(GLuint &current, GLuint value)
+{
+    if (current == value)
+    {
+        elided++;
+        return false;
+    }
+    current = value;
+    issued++;
+    return true;
+}
+
+bool GLStateCache::Changed(std::vector<Value> &values, GLenum name, GLuint owner, const void *value,
+                           size_t bytes)
+{
+    for (Value &known : values)
+    {
+        if (known.name == name && known.owner == owner)
+        {
+            if (std::memcmp(known.bits, value, bytes) == 0)
+            {
+                elided++;
+                return false;
+            }
+            std::memcpy(known.bits, value, bytes);
+            issued++;
+            return true;
+        }
+    }
+
+    Value known = {name, owner, {}};
+    std::memcpy(known.bits, value, bytes);
+    values.push_back(known);
+    issued++;
+    return true;
+}
+
+void GLStateCache::UseProgram(GLuint id)
+{
+    if (Changed(program, id))
+        glUseProgram(id);
+}
+
+void GLStateCache::BindVertexArray(GLuint id)
+{
+    if (Changed(vao, id))
+        glBindVertexArray(id);
+}
+
+void GLStateCache::BindArrayBuffer(GLuint id)
+{
+    if (Changed(arrayBuffer, id))
+        glBindBuffer(GL_ARRAY_BUFFER, id);
+}
+
+void GLStateCache::BindTexture2D(GLuint id)
+{
+    if (Changed(texture, id))
+        glBindTexture(GL_TEXTURE_2D, id);
+}
+
+void GLStateCache::BindFramebuffer(GLenum target, GLuint id)
+{
+    bool draw = target != GL_READ_FRAMEBUFFER && drawFramebuffer != id;
+    bool read = target != GL_DRAW_FRAMEBUFFER && readFramebuffer != id;
+    if (!draw && !read)
+    {
+        elided++;
+        return;
+    }
+    issued++;
+    if (target == GL_FRAMEBUFFER)
+    {
+        drawFramebuffer = readFramebuffer = id;
+    }
+    else if (target == GL_DRAW_FRAMEBUFFER)
+    {
+        drawFramebuffer = id;
+    }
+    else
+    {
+        readFramebuffer = id;
+    }
+    glBindFramebuffer(target, id);
+}
+
+// Binds `buffer` as well when the attribute has to be pointed again.
+bool GLStateCache::AttributeChanged(GLuint index, GLuint buffer, GLint size, GLenum type, GLsizei stride,
+                                    size_t offset, bool integer)
+{
+    GLuint format = (type & 0xffff) | GLuint(size) << 16 | GLuint(stride) << 19 | GLuint(integer) << 31;
+    GLuint value[3] = {buffer, static_cast<GLuint>(offset), format};
+    if (!Changed(attributes, index, vao, value, sizeof(value)))
+    {
+        return false;
+    }
+    BindArrayBuffer(buffer);
+    return true;
+}
+
+void GLStateCache::VertexAttribPointer(GLuint index, GLuint buffer, GLint size, GLenum type, GLsizei stride,
+                                       size_t offset)
+{
+    if (AttributeChanged(index, buffer, size, type, stride, offset, false))
+        glVertexAttribPointer(index, size, type, GL_FALSE, stride, (void *)offset);
+}
+
+void GLStateCache::VertexAttribIPointer(GLuint index, GLuint buffer, GLint size, GLenum type, GLsizei stride,
+                                        size_t offset)
+{
+    if (AttributeChanged(index, buffer, size, type, stride, offset, true))
+        glVertexAttribIPointer(index, size, type, stride, (void *)offset);
+}
+
+void GLStateCache::Viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    GLint value[4] = {x, y, width, height};
+    if (viewportKnown && std::equal(value, value + 4, viewport))
+    {
+        elided++;
+        return;
+    }
+    std::copy(value, value + 4, viewport);
+    viewportKnown = true;
+    issued++;
+    glViewport(x, y, width, height);
+}
+
+void GLStateCache::Scissor(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    GLint value[4] = {x, y, width, height};
+    if (scissorKnown && std::equal(value, value + 4, scissor))
+    {
+        elided++;
+        return;
+    }
+    std::copy(value, value + 4, scissor);
+    scissorKnown = true;
+    issued++;
+    glScissor(x, y, width, height);
+}
+
+void GLStateCache::ScissorTest(bool enabled)
+{
+    if (Changed(scissorTest, enabled ? 1 : 0))
+    {
+        if (enabled)
+            glEnable(GL_SCISSOR_TEST);
+        else
+            glDisable(GL_SCISSOR_TEST);
+    }
+}
+
+void GLStateCache::ClearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a)
+{
+    GLfloat value[4] = {r, g, b, a};
+    if (clearColorKnown && std::memcmp(value, clearColor, sizeof(value)) == 0)
+    {
+        elided++;
+        return;
+    }
+    std::memcpy(clearColor, value, sizeof(value));
+    clearColorKnown = true;
+    issued++;
+    glClearColor(r, g, b, a);
+}
+
+void GLStateCache::PixelStore(GLenum name, GLint value)
+{
+    if (Changed(pixelStore, name, 0, &value, sizeof(value)))
+        glPixelStorei(name, value);
+}
+
+void GLStateCache::Uniform1i(GLint location, GLint value)
+{
+    if (Changed(uniforms, location, program, &value, sizeof(value)))
+        glUniform1i(location, value);
+}
+
+void GLStateCache::Uniform1ui(GLint location, GLuint value)
+{
+    if (Changed(uniforms, location, program, &value, sizeof(value)))
+        glUniform1ui(location, value);
+}
+
+void GLStateCache::Uniform1f(GLint location, GLfloat value)
+{
+    if (Changed(uniforms, location, program, &value, sizeof(value)))
+        glUniform1f(location, value);
+}
+
+void GLStateCache::Uniform2i(GLint location, GLint x, GLint y)
+{
+    GLint value[2] = {x, y};
+    if (Changed(uniforms, location, program, value, sizeof(value)))
+        glUniform2i(location, x, y);
+}
+
+void GLStateCache::Uniform2f(GLint location, GLfloat x, GLfloat y)
+{
+    GLfloat value[2] = {x, y};
+    if (Changed(uniforms, location, program, value, sizeof(value)))
+        glUniform2f(location, x, y);
+}
+
+void GLStateCache::Uniform3fv(GLint location, const GLfloat *value)
+{
+    if (Changed(uniforms, location, program, value, 3 * sizeof(GLfloat)))
+        glUniform3fv(location, 1, value);
+}
+
+void GLStateCache::DeleteProgram(GLuint id)
+{
+    glDeleteProgram(id);
+    if (program == id)
+        program = UNKNOWN;
+    uniforms.erase(std::remove_if(uniforms.begin(), uniforms.end(),
+                                  [id](const Value &known) { return known.owner == id; }),
+                   uniforms.end());
+}
+
+void GLStateCache::DeleteVertexArray(GLuint id)
+{
+    glDeleteVertexArrays(1, &id);
+    if (vao == id)
+        vao = UNKNOWN;
+    attributes.erase(std::remove_if(attributes.begin(), attributes.end(),
+                                    [id](const Value &known) { return known.owner == id; }),
+                     attributes.end());
+}
+
+void GLStateCache::DeleteBuffer(GLuint id)
+{
+    glDeleteBuffers(1, &id);
+    if (arrayBuffer == id)
+        arrayBuffer = UNKNOWN;
+    // a new buffer can get the same name, attributes have to be pointed again
+    attributes.erase(std::remove_if(attributes.begin(), attributes.end(),
+                                    [id](const Value &known) { return known.bits[0] == id; }),
+                     attributes.end());
+}
+
+void GLStateCache::DeleteTexture(GLuint id)
+{
+    glDeleteTextures(1, &id);
+    if (texture == id)
+        texture = UNKNOWN;
+}
+
+void GLStateCache::DeleteFramebuffer(GLuint id)
+{
+    glDeleteFramebuffers(1, &id);
+    if (drawFramebuffer == id)
+        drawFramebuffer = 0; // GL falls back to the default framebuffer
+    if (readFramebuffer == id)
+        readFramebuffer = 0;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "GLExtensions.h"
+
+// Remembers the GL state the renderers set (bindings, vertex attribute
+// pointers, viewport, scissor, clear colour, pixel store and uniforms) and
+// drops calls that would set what is already there. Every change to that
+// state has to go through here, and tracked objects have to be deleted
+// through here, or the cache goes out of date; Reset makes it forget
+// everything.
+//
+// One context, used from one thread at a time.
+class GLStateCache
+{
+public:
+    GLStateCache();
+
+    // Assumes nothing about the current state, e.g. for a new context.
+    void Reset();
+
+    void UseProgram(GLuint program);
+    void BindVertexArray(GLuint vao);
+    void BindArrayBuffer(GLuint buffer);
+    void BindTexture2D(GLuint texture); // on texture unit 0, the only one used
+    // GL_FRAMEBUFFER binds both the draw and the read framebuffer.
+    void BindFramebuffer(GLenum target, GLuint framebuffer);
+    void Viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+    void Scissor(GLint x, GLint y, GLsizei width, GLsizei height);
+    void ScissorTest(bool enabled);
+    void ClearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a);
+    void PixelStore(GLenum name, GLint value);
+
+    // Points attribute `index` of the bound vertex array at `buffer`, from
+    // `offset` bytes in; as floats, or as integers for the I variant.
+    void VertexAttribPointer(GLuint index, GLuint buffer, GLint size, GLenum type, GLsizei stride,
+                             size_t offset);
+    void VertexAttribIPointer(GLuint index, GLuint buffer, GLint size, GLenum type, GLsizei stride,
+                              size_t offset);
+
+    // Uniforms of the program in use.
+    void Uniform1i(GLint location, GLint value);
+    void Uniform1ui(GLint location, GLuint value);
+    void Uniform1f(GLint location, GLfloat value);
+    void Uniform2i(GLint location, GLint x, GLint y);
+    void Uniform2f(GLint location, GLfloat x, GLfloat y);
+    void Uniform3fv(GLint location, const GLfloat *value);
+
+    // Deletes the object and forgets it, as GL unbinds a deleted object.
+    void DeleteProgram(GLuint program);
+    void DeleteVertexArray(GLuint vao);
+    void DeleteBuffer(GLuint buffer);
+    void DeleteTexture(GLuint texture);
+    void DeleteFramebuffer(GLuint framebuffer);
+
+    unsigned long long issued; // calls passed on to GL, over the whole run
+    unsigned long long elided; // calls dropped as redundant
+
+private:
+    struct Value
+    {
+        GLenum name;  // pixel store parameter, uniform location or attribute index
+        GLuint owner; // program of a uniform, vertex array of an attribute
+        GLuint bits[3];
+    };
+
+    bool Changed(GLuint &current, GLuint value);
+    bool Changed(std::vector<Value> &values, GLenum name, GLuint owner, const void *value,
+                 size_t bytes);
+    bool AttributeChanged(GLuint index, GLuint buffer, GLint size, GLenum type, GLsizei stride,
+                          size_t offset, bool integer);
+
+    GLuint program, vao, arrayBuffer, texture;
+    GLuint drawFramebuffer, readFramebuffer;
+    GLint viewport[4], scissor[4];
+    GLfloat clearColor[4];
+    bool viewportKnown, scissorKnown, clearColorKnown;
+    GLuint scissorTest; // 0 or 1, UNKNOWN after Reset
+    std::vector<Value> pixelStore;
+    std::vector<Value> uniforms;
+    std::vector<Value> attributes; // buffer, offset and format of each
+};
+
+// The cache for the one context the game draws with.
+extern GLStateCache glState;
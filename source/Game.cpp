@@ -0,0 +1,259 @@
+#include "Game.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <random>
+
+GameState::GameState()
+    : gridWidth(0), gridHeight(0), snakeDirection(Direction::None), score(0),
+      gameOver(false), gameWon(false), gameStarted(false), tickAccumulator(0.0),
+      maxTicksPerFrame(DEFAULT_MAX_TICKS_PER_FRAME), snakeSpeed(UPDATE_INTERVAL),
+      gameOverTime(0.0f), moves(0), games(0)
+{
+    std::random_device device;
+    rng.Seed((uint64_t(device()) << 32) | device());
+    SetGridSize(DEFAULT_GRID_SIZE, DEFAULT_GRID_SIZE);
+}
+
+void GameState::Seed(uint64_t seed, uint64_t stream)
+{
+    rng.Seed(seed, stream);
+    Restart(); // the current fruit came from the old sequence
+}
+
+void GameState::SetGridSize(int width, int height)
+{
+    assert(width >= Board::MIN_SIZE && height >= Board::MIN_SIZE);
+    assert(width <= Board::MAX_SIZE && height <= Board::MAX_SIZE);
+
+    gridWidth = width;
+    gridHeight = height;
+    board.Resize(width, height);
+
+    // the body only needs the full area on small boards, large ones grow it
+    snake = RingBuffer<vec2i>(static_cast<size_t>(std::min<int64_t>(board.Area(), 1 << 16)));
+
+    Restart();
+}
+
+void GameState::Restart()
+{
+    Reset();
+    SpawnFruit();
+}
+
+void GameState::Start()
+{
+    gameStarted = true;
+    snakeDirection = Direction::Right;
+}
+
+void GameState::Steer(Direction direction)
+{
+    switch (direction)
+    {
+    case Direction::Up:
+        if (snakeDirection != Direction::Down)
+            snakeDirection = Direction::Up;
+        break;
+    case Direction::Down:
+        if (snakeDirection != Direction::Up)
+            snakeDirection = Direction::Down;
+        break;
+    case Direction::Left:
+        if (snakeDirection != Direction::Right)
+            snakeDirection = Direction::Left;
+        break;
+    case Direction::Right:
+        if (snakeDirection != Direction::Left)
+            snakeDirection = Direction::Right;
+        break;
+    case Direction::None:
+        break;
+    }
+}
+
+void GameState::Update(float deltaTime)
+{
+    if (gameOver)
+    {
+        gameOverTime += deltaTime;
+        return;
+    }
+    if (!gameStarted)
+    {
+        return;
+    }
+
+    // Fixed-step accumulator: run every tick that is due, carrying the
+    // remainder into the next frame. After a long hitch only
+    // maxTicksPerFrame ticks are run and the rest of the backlog is dropped,
+    // so a slow frame cannot snowball into ever longer catch-up frames.
+    tickStats.realTime += deltaTime;
+    tickAccumulator += deltaTime;
+
+    int ticks = 0;
+    while (tickAccumulator >= snakeSpeed && !gameOver)
+    {
+        if (ticks == maxTicksPerFrame)
+        {
+            double dropped = tickAccumulator - std::fmod(tickAccumulator, snakeSpeed);
+            tickAccumulator -= dropped;
+            tickStats.droppedTime += dropped;
+            tickStats.cappedFrames++;
+            break;
+        }
+
+        double late = tickAccumulator - snakeSpeed;
+        tickStats.lateTime += late;
+        tickStats.maxLate = std::max(tickStats.maxLate, late);
+
+        tickAccumulator -= snakeSpeed;
+        tickStats.simTime += snakeSpeed;
+        tickStats.ticks++;
+        ticks++;
+        Step();
+    }
+}
+
+float GameState::TickAlpha() const
+{
+    if (!gameStarted || gameOver)
+    {
+        return 1.0f;
+    }
+    return std::min(1.0f, static_cast<float>(tickAccumulator / snakeSpeed));
+}
+
+void GameState::TakeSnapshot(GameSnapshot &snapshot) const
+{
+    snapshot.gridWidth = gridWidth;
+    snapshot.gridHeight = gridHeight;
+    snapshot.snake.resize(snake.size());
+    for (size_t i = 0; i < snake.size(); i++)
+    {
+        snapshot.snake[i] = snake[i];
+    }
+    snapshot.previousHead = previousHead;
+    snapshot.previousTail = previousTail;
+    snapshot.moves = moves;
+    snapshot.games = games;
+    snapshot.fruit = fruit;
+    snapshot.score = score;
+    snapshot.gameOver = gameOver;
+    snapshot.gameWon = gameWon;
+    snapshot.gameStarted = gameStarted;
+    snapshot.gameOverTime = gameOverTime;
+    snapshot.tickAlpha = TickAlpha();
+    snapshot.snakeSpeed = snakeSpeed;
+}
+
+void GameState::Step()
+{
+    vec2i newHead = snake[0];
+
+    switch (snakeDirection)
+    {
+    case Direction::Up:
+        newHead.y++;
+        break;
+    case Direction::Down:
+        newHead.y--;
+        break;
+    case Direction::Left:
+        newHead.x--;
+        break;
+    case Direction::Right:
+        newHead.x++;
+        break;
+
+    case Direction::None:
+        return;
+    }
+    if (newHead.x < 0 || newHead.x >= gridWidth ||
+        newHead.y < 0 || newHead.y >= gridHeight)
+    {
+
+        gameOver = true;
+        return;
+    }
+    // the tail is still marked here, moving into it is a collision
+    if (IsOccupied(newHead))
+    {
+        gameOver = true;
+        return;
+    }
+    previousHead = snake[0];
+    previousTail = snake.back();
+    snake.push_front(newHead);
+    SetOccupied(newHead, true);
+    moves++;
+    if (newHead == fruit)
+    {
+        score += 10;
+        if (!SpawnFruit())
+        {
+            gameWon = true;
+            gameOver = true;
+            return;
+        }
+
+        if (score % 50 == 0 && snakeSpeed > 0.05f)
+        {
+            snakeSpeed -= 0.01f;
+        }
+    }
+    else
+    {
+        SetOccupied(snake.back(), false);
+        snake.pop_back();
+    }
+}
+
+void GameState::Reset()
+{
+    vec2i start(gridWidth / 4, gridHeight / 2); // (5, 10) on the default board
+    snake.clear();
+    snake.push_back(start);
+    snake.push_back(vec2i(start.x - 1, start.y));
+    snake.push_back(vec2i(start.x - 2, start.y));
+    RebuildOccupancy();
+    previousHead = snake[0];
+    previousTail = snake.back();
+    moves = 0;
+    games++;
+    snakeDirection = Direction::None;
+    gameOver = false;
+    gameWon = false;
+    gameStarted = false;
+    score = 0;
+    tickAccumulator = 0.0;
+    gameOverTime = 0.0f;
+    snakeSpeed = UPDATE_INTERVAL;
+}
+
+bool GameState::SpawnFruit()
+{
+    return board.SampleFree(rng, fruit.x, fruit.y);
+}
+
+bool GameState::IsOccupied(const vec2i &cell) const
+{
+    return board.IsOccupied(cell.x, cell.y);
+}
+
+void GameState::SetOccupied(const vec2i &cell, bool occupied)
+{
+    board.SetOccupied(cell.x, cell.y, occupied);
+}
+
+void GameState::RebuildOccupancy()
+{
+    board.Clear();
+    for (size_t i = 0; i < snake.size(); i++)
+    {
+        SetOccupied(snake[i], true);
+    }
+}
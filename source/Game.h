@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Board.h"
+#include "RingBuffer.h"
+
+struct vec2i
+{
+    int x, y;
+    vec2i() : x(0), y(0) {}
+    vec2i(int x, int y) : x(x), y(y) {}
+
+    bool operator==(const vec2i &other) const
+    {
+        return x == other.x && y == other.y;
+    }
+};
+
+enum class Direction
+{
+    Up,
+    Down,
+    Left,
+    Right,
+    None
+};
+
+const int DEFAULT_GRID_SIZE = 20;
+const float UPDATE_INTERVAL = 0.15f;
+const int DEFAULT_MAX_TICKS_PER_FRAME = 5;
+
+// How the fixed-step simulation keeps up with real time, over the whole run.
+struct TickStats
+{
+    unsigned long long ticks = 0;        // simulation steps taken
+    unsigned long long cappedFrames = 0; // frames that hit maxTicksPerFrame
+    double realTime = 0.0;               // seconds of play fed into Update
+    double simTime = 0.0;                // seconds covered by those ticks
+    double droppedTime = 0.0;            // seconds discarded by the cap
+    double lateTime = 0.0;               // summed over ticks: how long past due each ran
+    double maxLate = 0.0;                // the latest any tick ran
+};
+
+// A copy of everything a renderer draws. It can be taken between ticks and
+// drawn on another thread while the simulation moves on.
+struct GameSnapshot
+{
+    int gridWidth = 0, gridHeight = 0;
+    std::vector<vec2i> snake; // [0] is the head
+    vec2i previousHead, previousTail;
+    unsigned long long moves = 0, games = 0; // as in GameState
+    vec2i fruit;
+    int score = 0;
+    bool gameOver = false;
+    bool gameWon = false;
+    bool gameStarted = false;
+    float gameOverTime = 0.0f;
+    float tickAlpha = 1.0f;  // TickAlpha() when taken
+    float snakeSpeed = 1.0f; // seconds per tick, to carry tickAlpha forward
+};
+
+// One snake game: board, snake, fruit, score and tick timing. It has no
+// window or GL dependency, so the same rules drive the windowed game, the
+// headless runner and the benchmarks.
+class GameState
+{
+public:
+    GameState();
+
+    // Reseeds fruit placement and starts a new game. The same seed, stream
+    // and inputs give a bit-identical game on every platform. Without a
+    // call the game is seeded from std::random_device.
+    void Seed(uint64_t seed, uint64_t stream = 0);
+
+    // Resizes the board (MIN_SIZE..MAX_SIZE per side) and starts a new game.
+    void SetGridSize(int width, int height);
+
+    // Back to the start screen with a fresh snake and fruit.
+    void Restart();
+    // Leaves the start screen; the snake sets off to the right.
+    void Start();
+    // Turns the snake, ignoring a turn straight back into itself.
+    void Steer(Direction direction);
+
+    // Advances real time, running as many fixed ticks as are due.
+    void Update(float deltaTime);
+    // One simulation tick, regardless of timing.
+    void Step();
+
+    // How far real time has run towards the next tick, 0..1, for renderers
+    // that blend from the previous tick to the current one. 1 while nothing
+    // is moving.
+    float TickAlpha() const;
+
+    // Copies the drawable state, reusing the snapshot's storage.
+    void TakeSnapshot(GameSnapshot &snapshot) const;
+
+    int gridWidth, gridHeight;
+    RingBuffer<vec2i> snake; // [0] is the head
+    Direction snakeDirection;
+    vec2i fruit;
+    int score;
+    bool gameOver;
+    bool gameWon; // the snake filled the whole board
+    bool gameStarted;
+    double tickAccumulator; // real time not yet simulated
+    int maxTicksPerFrame;
+    float snakeSpeed;
+    float gameOverTime;
+    TickStats tickStats;
+    Board board; // cells covered by the snake
+
+    // The ends of the snake before the last move; the rest of the body
+    // only shifts along by one cell. After growing previousTail is the
+    // current tail. Both match the current snake after a restart.
+    vec2i previousHead, previousTail;
+
+    // Head moves in the current game, and games begun (restarts included),
+    // so a renderer can tell how far the snake went since it last looked.
+    unsigned long long moves, games;
+
+private:
+    void Reset();
+    bool SpawnFruit();
+    bool IsOccupied(const vec2i &cell) const;
+    void SetOccupied(const vec2i &cell, bool occupied);
+    void RebuildOccupancy();
+
+    Random rng;
+};
@@ -0,0 +1,1062 @@
+#include "GameRenderer.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "BoardRenderer.h"
+#include "CellRenderer.h"
+#include "FrameProfiler.h"
+#include "GLStateCache.h"
+#include "RenderCommands.h"
+#include "SnakeMesh.h"
+
+struct vec2
+{
+    float x, y;
+    vec2() : x(0.0f), y(0.0f) {}
+    vec2(float x, float y) : x(x), y(y) {}
+};
+
+struct vec3
+{
+    float r, g, b;
+    vec3() : r(0.0f), g(0.0f), b(0.0f) {}
+    vec3(float r, float g, float b) : r(r), g(g), b(b) {}
+};
+
+const int MAX_VIEW_CELLS = 40; // bigger boards scroll to follow the head
+
+vec2i viewOrigin;            // board cell shown in the bottom-left corner
+int viewWidth, viewHeight;   // cells visible on screen
+vec2i viewGrid;              // board size the view was laid out for
+float cellWidth, cellHeight; // size of one visible cell in NDC
+bool backgroundDirty = true; // the cached board background needs rebuilding
+
+CellRenderer renderer;         // the GL backend
+RenderBackend *backend = nullptr; // the one the current frame goes to
+RenderCommands commands;       // the frame being recorded for it
+bool glyphsPacked = false;
+
+// The frame's layers, bottom first.
+enum Layer : uint8_t
+{
+    BoardLayer,
+    SnakeLayer,
+    TextLayer,
+    OverlayLayer,
+};
+
+BoardRenderer board;    // the board as one shader pass, with --board-texture
+bool useBoardPass = false;
+SnakeMesh snakeMesh;    // the GL backend's snake body, kept on the GPU
+bool useSnakeMesh = false;
+
+FrameProfiler profiler; // only runs while the overlay is shown
+bool overlayVisible = false;
+HostStats overlayHost;
+
+// What the last retained frame showed of what can change while the scene
+// stays the same, to tell what the next frame has to draw again.
+struct ShownFrame
+{
+    bool valid = false;
+    int screen = 0; // 0 start, 1 playing, 2 game over
+    int width = 0, height = 0;
+    bool overlay = false, boardPass = false;
+    vec2i viewOrigin, viewSize, grid;
+    unsigned long long games = 0, moves = 0;
+    vec2 head, tail; // the sliding ends, in cells
+    vec2i fruit;
+    vec2i bodyLow, bodyHigh; // cells the body covers, on a playing frame
+    int score = 0;
+    vec2 scoreLow, scoreHigh; // corners of the score text in NDC, on a playing frame
+    float border = 0.0f; // red of the pulsing game-over border
+};
+ShownFrame shown;
+const size_t MAX_DAMAGE_RECTS = 8; // more are merged into one
+
+// The overlay panel, in NDC from its top left corner.
+const float OVERLAY_LEFT = -0.98f, OVERLAY_TOP = 0.98f;
+const float OVERLAY_WIDTH = 0.9f;
+const float OVERLAY_HEIGHT = 2 * 0.15f + 6 * 0.04f + 0.08f; // two graphs, six lines
+
+// CPU cost of building and submitting frames, over the whole run.
+unsigned long long frameCount = 0;
+double renderSeconds = 0.0;
+
+const int FONT_WITH = 5;
+const int FONT_HEIGHT = 5;
+const int FONT_SPACING = 1;
+
+std::map<char, std::vector<int>> fontMap = {
+    {' ', {0,0,0,0,0, 0,0,0,0,0, 0,0,0,0,0, 0,0,0,0,0, 0,0,0,0,0}},
+    {'A', {0,1,1,0,0, 1,0,0,1,0, 1,1,1,1,0, 1,0,0,1,0, 1,0,0,1,0}},
+    {'B', {1,1,1,0,0, 1,0,0,1,0, 1,1,1,0,0, 1,0,0,1,0, 1,1,1,0,0}},
+    {'C', {0,1,1,1,0, 1,0,0,0,0, 1,0,0,0,0, 1,0,0,0,0, 0,1,1,1,0}},
+    {'D', {1,1,1,0,0, 1,0,0,1,0, 1,0,0,1,0, 1,0,0,1,0, 1,1,1,0,0}},
+    {'E', {1,1,1,1,0, 1,0,0,0,0, 1,1,1,0,0, 1,0,0,0,0, 1,1,1,1,0}},
+    {'F', {1,1,1,1,0, 1,0,0,0,0, 1,1,1,0,0, 1,0,0,0,0, 1,0,0,0,0}},
+    {'G', {0,1,1,1,0, 1,0,0,0,0, 1,0,1,1,0, 1,0,0,1,0, 0,1,1,1,0}},
+    {'H', {1,0,0,1,0, 1,0,0,1,0, 1,1,1,1,0, 1,0,0,1,0, 1,0,0,1,0}},
+    {'I', {1,1,1,0,0, 0,1,0,0,0, 0,1,0,0,0, 0,1,0,0,0, 1,1,1,0,0}},
+    {'J', {0,0,1,1,0, 0,0,0,1,0, 0,0,0,1,0, 1,0,0,1,0, 0,1,1,0,0}},
+    {'K', {1,0,0,1,0, 1,0,1,0,0, 1,1,0,0,0, 1,0,1,0,0, 1,0,0,1,0}},
+    {'L', {1,0,0,0,0, 1,0,0,0,0, 1,0,0,0,0, 1,0,0,0,0, 1,1,1,1,0}},
+    {'M', {1,0,0,0,1, 1,1,0,1,1, 1,0,1,0,1, 1,0,0,0,1, 1,0,0,0,1}},
+    {'N', {1,0,0,0,1, 1,1,0,0,1, 1,0,1,0,1, 1,0,0,1,1, 1,0,0,0,1}},
+    {'O', {0,1,1,0,0, 1,0,0,1,0, 1,0,0,1,0, 1,0,0,1,0, 0,1,1,0,0}},
+    {'P', {1,1,1,0,0, 1,0,0,1,0, 1,1,1,0,0, 1,0,0,0,0, 1,0,0,0,0}},
+    {'Q', {0,1,1,0,0, 1,0,0,1,0, 1,0,0,1,0, 1,0,1,0,0, 0,1,0,1,0}},
+    {'R', {1,1,1,0,0, 1,0,0,1,0, 1,1,1,0,0, 1,0,1,0,0, 1,0,0,1,0}},
+    {'S', {0,1,1,1,0, 1,0,0,0,0, 0,1,1,0,0, 0,0,0,1,0, 1,1,1,0,0}},
+    {'T', {1,1,1,1,1, 0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0}},
+    {'U', {1,0,0,1,0, 1,0,0,1,0, 1,0,0,1,0, 1,0,0,1,0, 0,1,1,0,0}},
+    {'V', {1,0,0,0,1, 1,0,0,0,1, 0,1,0,1,0, 0,1,0,1,0, 0,0,1,0,0}},
+    {'W', {1,0,0,0,1, 1,0,0,0,1, 1,0,1,0,1, 1,0,1,0,1, 0,1,0,1,0}},
+    {'X', {1,0,0,0,1, 0,1,0,1,0, 0,0,1,0,0, 0,1,0,1,0, 1,0,0,0,1}},
+    {'Y', {1,0,0,0,1, 0,1,0,1,0, 0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0}},
+    {'Z', {1,1,1,1,1, 0,0,0,1,0, 0,0,1,0,0, 0,1,0,0,0, 1,1,1,1,1}},
+    {'0', {0,1,1,0,0, 1,0,0,1,0, 1,0,0,1,0, 1,0,0,1,0, 0,1,1,0,0}},
+    {'1', {0,0,1,0,0, 0,1,1,0,0, 0,0,1,0,0, 0,0,1,0,0, 0,1,1,1,0}},
+    {'2', {0,1,1,0,0, 1,0,0,1,0, 0,0,1,0,0, 0,1,0,0,0, 1,1,1,1,0}},
+    {'3', {1,1,1,0,0, 0,0,0,1,0, 0,1,1,0,0, 0,0,0,1,0, 1,1,1,0,0}},
+    {'4', {0,0,1,1,0, 0,1,0,1,0, 1,0,0,1,0, 1,1,1,1,1, 0,0,0,1,0}},
+    {'5', {1,1,1,1,0, 1,0,0,0,0, 1,1,1,0,0, 0,0,0,1,0, 1,1,1,0,0}},
+    {'6', {0,1,1,0,0, 1,0,0,0,0, 1,1,1,0,0, 1,0,0,1,0, 0,1,1,0,0}},
+    {'7', {1,1,1,1,0, 0,0,0,1,0, 0,0,1,0,0, 0,1,0,0,0, 1,0,0,0,0}},
+    {'8', {0,1,1,0,0, 1,0,0,1,0, 0,1,1,0,0, 1,0,0,1,0, 0,1,1,0,0}},
+    {'9', {0,1,1,0,0, 1,0,0,1,0, 0,1,1,1,0, 0,0,0,1,0, 0,1,1,0,0}},
+    {':', {0,0,0,0,0, 0,0,1,0,0, 0,0,0,0,0, 0,0,1,0,0, 0,0,0,0,0}},
+    {'-', {0,0,0,0,0, 0,0,0,0,0, 1,1,1,1,0, 0,0,0,0,0, 0,0,0,0,0}},
+    {'.', {0,0,0,0,0, 0,0,0,0,0, 0,0,0,0,0, 0,0,0,0,0, 0,0,1,0,0}}
+};
+
+// fontMap packed once at startup: one mask per ASCII code, bit
+// (row * FONT_WITH + column) set for a lit pixel, zero for unknown characters
+uint32_t glyphMasks[128];
+
+// The pixels of one string, laid out once and queued again on every frame
+// it is shown.
+typedef std::vector<CellInstance> TextMesh;
+
+void DrawCell(const vec2i &position, const vec3 &color);
+void DrawCell(const vec2 &position, const vec3 &color);
+vec2 Lerp(const vec2i &from, const vec2i &to, float alpha);
+void PackGlyphs();
+void AddChar(TextMesh &mesh, char c, float x, float y, float scale, const vec3 &color);
+TextMesh BuildText(const std::string &text, float x, float y, float scale, const vec3 &color);
+void DrawText(const TextMesh &mesh);
+void DrawBorder(const GameSnapshot &state);
+vec3 SegmentColor(size_t index, size_t length);
+void DrawSnake(const GameSnapshot &state, float alpha);
+void DrawSnakeEnds(const GameSnapshot &state, float alpha);
+vec3 GameOverBorderColor(float gameOverTime);
+void DrawScore(const GameSnapshot &state);
+const TextMesh &ScoreText(int score);
+void DrawGameOverBoard(float gameOverTime);
+void DrawGameOver(const GameSnapshot &state);
+void DrawStartScreen();
+void DrawAnimatedGameOverBorder(float gameOverTime);
+void UpdateView(const GameSnapshot &state);
+void AppendText(TextMesh &mesh, const std::string &text, float left, float y, float scale,
+                const vec3 &color);
+void EndPhase(FrameProfiler::Phase phase);
+void DrawPerfOverlay();
+void DrawScene(const GameSnapshot &state, float alpha, float gameOverTime, bool boardPass, bool meshSnake,
+               int framebufferWidth, int framebufferHeight);
+bool SetDamage(const GameSnapshot &state, float alpha, float gameOverTime, bool boardPass, bool resized,
+               int framebufferWidth, int framebufferHeight);
+void AddDamage(std::vector<CellRenderer::Rect> &rects, float left, float bottom, float right, float top,
+               int framebufferWidth, int framebufferHeight);
+void AddCellDamage(std::vector<CellRenderer::Rect> &rects, const vec2 &low, const vec2 &high,
+                   int framebufferWidth, int framebufferHeight);
+void TextBounds(const TextMesh &mesh, vec2 &low, vec2 &high);
+
+bool InitGameRenderer(GLADloadproc load, bool persistentMapping, bool boardPass, bool damageTracking)
+{
+    if (!gladLoadGLLoader(load))
+    {
+        std::cerr << "Failed to initialize GLAD\n";
+        return false;
+    }
+    if (!LoadGLExtensions(load))
+    {
+        std::cerr << "OpenGL 3.3 is required\n";
+        return false;
+    }
+
+    backgroundDirty = true;
+    glState.Reset();
+    shown = ShownFrame();
+    if (!renderer.Init(persistentMapping, damageTracking))
+    {
+        return false;
+    }
+    useBoardPass = boardPass && board.Init();
+    useSnakeMesh = snakeMesh.Init();
+    profiler.Init();
+    return true;
+}
+
+void ShutdownGameRenderer()
+{
+    profiler.Shutdown();
+    if (useBoardPass)
+    {
+        board.Shutdown();
+    }
+    if (useSnakeMesh)
+    {
+        snakeMesh.Shutdown();
+    }
+    renderer.Shutdown();
+    glState.Reset();
+}
+
+void SetPerfOverlay(bool visible, const HostStats &host)
+{
+    if (visible && !overlayVisible)
+    {
+        profiler.Reset(); // the frames before were not timed
+    }
+    overlayVisible = visible;
+    overlayHost = host;
+}
+
+void FramePresented()
+{
+    if (overlayVisible)
+    {
+        profiler.Mark(FrameProfiler::Swap);
+        profiler.EndFrame();
+    }
+}
+
+void PrintRenderStats(std::ostream &out)
+{
+    if (frameCount > 0 && backend)
+    {
+        out << "frames: " << frameCount
+            << ", draw calls/frame: " << double(backend->drawCalls) / frameCount
+            << ", cells/frame: " << double(backend->instances) / frameCount
+            << ", CPU render time/frame: " << renderSeconds / frameCount * 1000.0 << "ms"
+            << ", background rebuilds: " << backend->backgroundBuilds << "\n";
+    }
+    const StreamBuffer &stream = renderer.stream;
+    if (stream.frames > 0)
+    {
+        out << "instance stream: " << (stream.IsPersistent() ? "persistent" : "orphaned")
+            << ", bytes/frame: " << double(stream.bytesUploaded) / stream.frames
+            << ", stall/frame: " << stream.stallSeconds / stream.frames * 1000.0 << "ms\n";
+    }
+    if (frameCount > 0 && glState.issued + glState.elided > 0)
+    {
+        out << "GL state calls/frame: " << double(glState.issued) / frameCount
+            << ", elided/frame: " << double(glState.elided) / frameCount << "\n";
+    }
+    if (renderer.framePixels > 0)
+    {
+        out << "damage: pixels redrawn: " << 100.0 * renderer.damagedPixels / renderer.framePixels
+            << "%, frames with nothing to redraw: " << renderer.emptyFrames << "\n";
+    }
+    if (useSnakeMesh && frameCount > 0)
+    {
+        out << "snake mesh: slots uploaded/frame: " << double(snakeMesh.slotsUploaded) / frameCount
+            << ", full uploads: " << snakeMesh.fullUploads
+            << ", stall/frame: " << snakeMesh.stallSeconds * 1000.0 / frameCount << "ms\n";
+    }
+    if (useBoardPass && frameCount > 0)
+    {
+        out << "board texture: cells uploaded/frame: " << double(board.cellsUploaded) / frameCount
+            << ", full uploads: " << board.fullUploads << "\n";
+    }
+
+    // means over the frames still in the profiler's history
+    FrameProfiler::Sample sample;
+    double cpuMs[FrameProfiler::PHASE_COUNT] = {}, gpuMs[FrameProfiler::PHASE_COUNT] = {};
+    int profiled = 0, gpuProfiled = 0;
+    for (int age = 0; profiler.Get(age, sample); age++)
+    {
+        for (int phase = 0; phase < FrameProfiler::PHASE_COUNT; phase++)
+        {
+            cpuMs[phase] += sample.cpuMs[phase];
+            gpuMs[phase] += sample.hasGpu ? sample.gpuMs[phase] : 0.0f;
+        }
+        profiled++;
+        gpuProfiled += sample.hasGpu;
+    }
+    if (profiled > 0)
+    {
+        const char *names[] = {"border", "snake", "text", "swap"};
+        out << "profiled frames: " << profiled << ", CPU/GPU ms per phase:";
+        for (int phase = 0; phase < FrameProfiler::PHASE_COUNT; phase++)
+        {
+            out << " " << names[phase] << " " << cpuMs[phase] / profiled << "/";
+            if (gpuProfiled > 0)
+                out << gpuMs[phase] / gpuProfiled;
+            else
+                out << "-";
+        }
+        out << "\n";
+    }
+}
+
+void RenderGame(const GameSnapshot &state, float sinceSnapshot, int framebufferWidth, int framebufferHeight)
+{
+    RenderGame(renderer, state, sinceSnapshot, framebufferWidth, framebufferHeight);
+}
+
+void RenderGame(RenderBackend &target, const GameSnapshot &state, float sinceSnapshot,
+                int framebufferWidth, int framebufferHeight)
+{
+    if (!glyphsPacked)
+    {
+        PackGlyphs();
+        glyphsPacked = true;
+    }
+    // the background layer lives in the backend that built it
+    if (&target != backend)
+    {
+        backend = &target;
+        backgroundDirty = true;
+    }
+
+    // carry the snapshot forward to now
+    float alpha = state.tickAlpha;
+    float gameOverTime = state.gameOverTime;
+    if (state.gameOver)
+    {
+        gameOverTime += sinceSnapshot;
+    }
+    else if (state.gameStarted)
+    {
+        alpha = std::min(1.0f, alpha + sinceSnapshot / state.snakeSpeed);
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    if (overlayVisible)
+    {
+        profiler.BeginFrame(backend == &renderer);
+    }
+    unsigned long long drawCallsBefore = backend->drawCalls;
+    unsigned long long cellsBefore = backend->instances;
+    unsigned long long stateCallsBefore = glState.issued;
+    unsigned long long stateElidedBefore = glState.elided;
+
+    bool resized = backend->BeginFrame(framebufferWidth, framebufferHeight, 0.08f, 0.1f, 0.12f);
+    if (resized)
+    {
+        backgroundDirty = true;
+    }
+    UpdateView(state);
+
+    // the board pass replaces the background layer and the board's cells
+    bool boardPass = useBoardPass && backend == &renderer && board.Update(state);
+    // and with it the snake is drawn from the board too
+    bool playing = state.gameStarted && !state.gameOver;
+    bool meshSnake = useSnakeMesh && playing && !boardPass && backend == &renderer && snakeMesh.Update(state);
+
+    // retained, only what changed since the last frame is drawn again
+    bool damaged = true;
+    if (backend == &renderer && renderer.Retained())
+    {
+        damaged = SetDamage(state, alpha, gameOverTime, boardPass, resized, framebufferWidth,
+                            framebufferHeight);
+    }
+    if (damaged)
+    {
+        DrawScene(state, alpha, gameOverTime, boardPass, meshSnake, framebufferWidth, framebufferHeight);
+    }
+    backend->Submit(commands);
+    commands.Clear();
+    if (overlayVisible)
+    {
+        profiler.Mark(FrameProfiler::Text);
+        profiler.Count(backend->drawCalls - drawCallsBefore, backend->instances - cellsBefore,
+                       glState.issued - stateCallsBefore, glState.elided - stateElidedBefore);
+    }
+    backend->EndFrame();
+    if (meshSnake)
+    {
+        snakeMesh.EndFrame();
+    }
+
+    // presenting is left to the caller, a swap blocks on vsync rather than costing CPU
+    renderSeconds += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    frameCount++;
+}
+
+// Records everything on screen into `commands`. The GL backend's own
+// passes are recorded as callbacks that draw over each damaged rectangle
+// when submitted.
+void DrawScene(const GameSnapshot &state, float alpha, float gameOverTime, bool boardPass, bool meshSnake,
+               int framebufferWidth, int framebufferHeight)
+{
+    bool playing = state.gameStarted && !state.gameOver;
+    commands.SetLayer(BoardLayer);
+    if (boardPass)
+    {
+        vec3 border = GameOverBorderColor(gameOverTime);
+        bool gameOver = state.gameOver;
+        commands.Draw([=]
+        {
+            const float borderColor[3] = {border.r, border.g, border.b};
+            renderer.ForEachDamageRect([&]
+            {
+                board.Draw(viewOrigin, viewWidth, viewHeight, framebufferWidth, framebufferHeight, playing,
+                           gameOver, borderColor);
+            });
+        });
+    }
+    else
+    {
+        if (backgroundDirty)
+        {
+            commands.BeginBackground();
+            DrawBorder(state);
+            commands.EndBackground();
+            backgroundDirty = false;
+        }
+        commands.Background();
+        if (state.gameOver)
+        {
+            DrawGameOverBoard(gameOverTime);
+        }
+    }
+    EndPhase(FrameProfiler::Border);
+
+    commands.SetLayer(SnakeLayer);
+    if (playing)
+    {
+        if (boardPass)
+        {
+            DrawSnakeEnds(state, alpha);
+        }
+        else if (meshSnake)
+        {
+            // the body is already on the GPU, drawn under the sliding ends
+            commands.Draw([]
+            {
+                size_t segments = 0;
+                renderer.ForEachDamageRect(
+                    [&] { segments = snakeMesh.Draw(viewOrigin, cellWidth, cellHeight); });
+                backend->drawCalls += segments > 0;
+                backend->instances += segments;
+            });
+            DrawSnakeEnds(state, alpha);
+            DrawCell(state.fruit, vec3(1.0f, 0.3f, 0.3f)); // fruit color
+        }
+        else
+        {
+            DrawSnake(state, alpha);
+        }
+    }
+    EndPhase(FrameProfiler::Snake);
+
+    commands.SetLayer(TextLayer);
+    if (!state.gameStarted)
+    {
+        DrawStartScreen();
+    }
+    else if (state.gameOver)
+    {
+        DrawGameOver(state);
+    }
+    else
+    {
+        DrawScore(state);
+    }
+    if (overlayVisible)
+    {
+        commands.SetLayer(OverlayLayer);
+        DrawPerfOverlay();
+    }
+}
+
+// Works out what changed since the last retained frame and hands it to
+// the renderer as the damage. False if there is nothing to draw at all.
+bool SetDamage(const GameSnapshot &state, float alpha, float gameOverTime, bool boardPass, bool resized,
+               int framebufferWidth, int framebufferHeight)
+{
+    ShownFrame now;
+    now.valid = true;
+    now.screen = !state.gameStarted ? 0 : state.gameOver ? 2 : 1;
+    now.width = framebufferWidth;
+    now.height = framebufferHeight;
+    now.overlay = overlayVisible;
+    now.boardPass = boardPass;
+    now.viewOrigin = viewOrigin;
+    now.viewSize = vec2i(viewWidth, viewHeight);
+    now.grid = vec2i(state.gridWidth, state.gridHeight);
+    now.games = state.games;
+    now.moves = state.moves;
+    now.score = state.score;
+    if (now.screen == 1)
+    {
+        now.head = Lerp(state.previousHead, state.snake[0], alpha);
+        now.tail = Lerp(state.previousTail, state.snake.back(), alpha);
+        now.fruit = state.fruit;
+        now.bodyLow = now.bodyHigh = state.snake[0];
+        // a box carried over has to be of this very snake, drawn last frame
+        if (shown.screen != 1 || now.moves != shown.moves || now.games != shown.games ||
+            !shown.valid)
+        {
+            // Every segment's colour shifts along the gradient with a move,
+            // so the whole box is redrawn on each tick. A known limit: a
+            // snake spread over the view makes most ticks close to a full
+            // redraw. Only a gradient that stays put per cell would avoid
+            // it, and the texture and mesh paths shift theirs the same way.
+            for (const vec2i &cell : state.snake)
+            {
+                now.bodyLow = vec2i(std::min(now.bodyLow.x, cell.x), std::min(now.bodyLow.y, cell.y));
+                now.bodyHigh = vec2i(std::max(now.bodyHigh.x, cell.x), std::max(now.bodyHigh.y, cell.y));
+            }
+        }
+        else
+        {
+            now.bodyLow = shown.bodyLow;
+            now.bodyHigh = shown.bodyHigh;
+        }
+
+        // measured once per score, the text is laid out anyway to be drawn
+        if (shown.screen != 1 || now.score != shown.score || !shown.valid)
+        {
+            TextBounds(ScoreText(now.score), now.scoreLow, now.scoreHigh);
+        }
+        else
+        {
+            now.scoreLow = shown.scoreLow;
+            now.scoreHigh = shown.scoreHigh;
+        }
+    }
+    else if (now.screen == 2)
+    {
+        now.border = GameOverBorderColor(gameOverTime).r;
+    }
+
+    ShownFrame before = shown;
+    shown = now;
+
+    // anything that moves the whole picture is drawn in full
+    if (!before.valid || resized || now.screen != before.screen || now.width != before.width ||
+        now.height != before.height || now.overlay != before.overlay || now.boardPass != before.boardPass ||
+        !(now.viewOrigin == before.viewOrigin) || !(now.viewSize == before.viewSize) ||
+        !(now.grid == before.grid) || now.games != before.games)
+    {
+        return true;
+    }
+
+    std::vector<CellRenderer::Rect> rects;
+    int w = framebufferWidth, h = framebufferHeight;
+    if (now.screen == 1)
+    {
+        // one cell's area, at a board position that may be between cells
+        auto addCell = [&](const vec2 &at) { AddCellDamage(rects, at, vec2(at.x + 1.0f, at.y + 1.0f), w, h); };
+
+        // the sliding ends, where they were and where they are now
+        if (now.head.x != before.head.x || now.head.y != before.head.y)
+        {
+            addCell(now.head);
+            addCell(before.head);
+        }
+        if (now.tail.x != before.tail.x || now.tail.y != before.tail.y)
+        {
+            addCell(now.tail);
+            addCell(before.tail);
+        }
+        if (now.moves != before.moves)
+        {
+            AddCellDamage(rects, vec2(float(now.bodyLow.x), float(now.bodyLow.y)),
+                          vec2(now.bodyHigh.x + 1.0f, now.bodyHigh.y + 1.0f), w, h);
+            AddCellDamage(rects, vec2(float(before.bodyLow.x), float(before.bodyLow.y)),
+                          vec2(before.bodyHigh.x + 1.0f, before.bodyHigh.y + 1.0f), w, h);
+        }
+        if (!(now.fruit == before.fruit))
+        {
+            addCell(vec2(float(now.fruit.x), float(now.fruit.y)));
+            addCell(vec2(float(before.fruit.x), float(before.fruit.y)));
+        }
+        if (now.score != before.score)
+        {
+            AddDamage(rects, before.scoreLow.x, before.scoreLow.y, before.scoreHigh.x, before.scoreHigh.y, w, h);
+            AddDamage(rects, now.scoreLow.x, now.scoreLow.y, now.scoreHigh.x, now.scoreHigh.y, w, h);
+        }
+    }
+    else if (now.screen == 2 && now.border != before.border)
+    {
+        // the pulsing ring of cells around the view
+        float left = float(viewOrigin.x), bottom = float(viewOrigin.y);
+        float right = left + viewWidth, top = bottom + viewHeight;
+        AddCellDamage(rects, vec2(left, bottom), vec2(right, bottom + 1.0f), w, h);
+        AddCellDamage(rects, vec2(left, top - 1.0f), vec2(right, top), w, h);
+        AddCellDamage(rects, vec2(left, bottom), vec2(left + 1.0f, top), w, h);
+        AddCellDamage(rects, vec2(right - 1.0f, bottom), vec2(right, top), w, h);
+    }
+    if (now.overlay)
+    {
+        AddDamage(rects, OVERLAY_LEFT, OVERLAY_TOP - OVERLAY_HEIGHT, OVERLAY_LEFT + OVERLAY_WIDTH,
+                  OVERLAY_TOP, w, h);
+    }
+
+    if (rects.size() > MAX_DAMAGE_RECTS)
+    {
+        CellRenderer::Rect all = rects[0];
+        for (const CellRenderer::Rect &rect : rects)
+        {
+            int right = std::max(all.x + all.width, rect.x + rect.width);
+            int top = std::max(all.y + all.height, rect.y + rect.height);
+            all.x = std::min(all.x, rect.x);
+            all.y = std::min(all.y, rect.y);
+            all.width = right - all.x;
+            all.height = top - all.y;
+        }
+        rects.assign(1, all);
+    }
+    renderer.SetDamage(rects);
+    return !rects.empty();
+}
+
+// An area in NDC, widened to whole pixels plus one for the rasterizer's
+// rounding.
+void AddDamage(std::vector<CellRenderer::Rect> &rects, float left, float bottom, float right, float top,
+               int framebufferWidth, int framebufferHeight)
+{
+    int x0 = int(std::floor((left + 1.0f) * 0.5f * framebufferWidth)) - 1;
+    int y0 = int(std::floor((bottom + 1.0f) * 0.5f * framebufferHeight)) - 1;
+    int x1 = int(std::ceil((right + 1.0f) * 0.5f * framebufferWidth)) + 1;
+    int y1 = int(std::ceil((top + 1.0f) * 0.5f * framebufferHeight)) + 1;
+    rects.push_back({x0, y0, x1 - x0, y1 - y0});
+}
+
+// Board cells from low to high, in cells like DrawCell's positions.
+void AddCellDamage(std::vector<CellRenderer::Rect> &rects, const vec2 &low, const vec2 &high,
+                   int framebufferWidth, int framebufferHeight)
+{
+    AddDamage(rects, -1.0f + (low.x - viewOrigin.x) * cellWidth, -1.0f + (low.y - viewOrigin.y) * cellHeight,
+              -1.0f + (high.x - viewOrigin.x) * cellWidth, -1.0f + (high.y - viewOrigin.y) * cellHeight,
+              framebufferWidth, framebufferHeight);
+}
+
+// The corners of the area a text mesh covers, in NDC; an empty mesh
+// covers nothing.
+void TextBounds(const TextMesh &mesh, vec2 &low, vec2 &high)
+{
+    low = vec2(1.0f, 1.0f);
+    high = vec2(-1.0f, -1.0f);
+    for (const CellInstance &pixel : mesh)
+    {
+        low.x = std::min(low.x, pixel.x - pixel.width / 2.0f);
+        high.x = std::max(high.x, pixel.x + pixel.width / 2.0f);
+        low.y = std::min(low.y, pixel.y - pixel.height / 2.0f);
+        high.y = std::max(high.y, pixel.y + pixel.height / 2.0f);
+    }
+    if (mesh.empty())
+    {
+        low = high = vec2();
+    }
+}
+
+void DrawCell(const vec2i &position, const vec3 &color)
+{
+    DrawCell(vec2(float(position.x), float(position.y)), color);
+}
+
+// Board position in cells, fractional while the snake is between cells.
+void DrawCell(const vec2 &position, const vec3 &color)
+{
+    float x = position.x - viewOrigin.x;
+    float y = position.y - viewOrigin.y;
+    if (x < -1 || x > viewWidth || y < -1 || y > viewHeight)
+    {
+        return; // scrolled out of view
+    }
+
+    vec2 offsSet(-1.0f + x * cellWidth + cellWidth * 0.5f,
+                 -1.0f + y * cellHeight + cellHeight * 0.5f);
+    vec2 scale(cellWidth * 0.9f, cellHeight * 0.9f);
+
+    commands.Cell(offsSet.x, offsSet.y, scale.x, scale.y, color.r, color.g, color.b);
+}
+
+void PackGlyphs()
+{
+    for (const auto &glyph : fontMap)
+    {
+        uint32_t mask = 0;
+        for (int i = 0; i < FONT_WITH * FONT_HEIGHT; i++)
+        {
+            if (glyph.second[i])
+            {
+                mask |= 1u << i;
+            }
+        }
+        glyphMasks[static_cast<unsigned char>(glyph.first) & 127] = mask;
+    }
+}
+
+void AddChar(TextMesh &mesh, char c, float x, float y, float scale, const vec3 &color)
+{
+    uint32_t mask = glyphMasks[std::toupper(static_cast<unsigned char>(c)) & 127];
+    float charWidth = FONT_WITH * scale;
+    float charHeight = FONT_HEIGHT * scale;
+
+    for (int i = 0; mask != 0; i++, mask >>= 1)
+    {
+        if (mask & 1)
+        {
+            int row = i / FONT_WITH;
+            int column = i % FONT_WITH;
+            mesh.push_back({x + column * scale - charWidth / 2.0f,
+                            y - row * scale + charHeight / 2.0f,
+                            scale, scale, color.r, color.g, color.b});
+        }
+    }
+}
+
+TextMesh BuildText(const std::string &text, float x, float y, float scale, const vec3 &color)
+{
+    float charWith = FONT_WITH * scale;
+    float spacing = FONT_SPACING * scale;
+    float tolalWidth = text.size() * (charWith + spacing) - spacing;
+
+    TextMesh mesh;
+    float startX = x - tolalWidth / 2.0f;
+    for (size_t i = 0; i < text.size(); i++)
+    {
+        AddChar(mesh, text[i], startX + i * (charWith + spacing), y, scale, color);
+    }
+    return mesh;
+}
+
+// The mesh is drawn where it is, so it has to stay as it is until the frame
+// is submitted.
+void DrawText(const TextMesh &mesh)
+{
+    commands.Text(mesh);
+}
+
+void DrawBorder(const GameSnapshot &state)
+{
+    vec3 borderColor(0.3f, 0.3f, 0.5f);
+    vec3 gridColor(0.082f, 0.106f, 0.329f);
+
+    // only the visible window of the board, plus the ring just outside it
+    for (int x = viewOrigin.x - 1; x <= viewOrigin.x + viewWidth; x++)
+    {
+        for (int y = viewOrigin.y - 1; y <= viewOrigin.y + viewHeight; y++)
+        {
+            bool insideX = x >= 0 && x < state.gridWidth;
+            bool insideY = y >= 0 && y < state.gridHeight;
+
+            if (insideX && insideY)
+            {
+                if ((x + y) % 2 == 0)
+                {
+                    DrawCell(vec2i(x, y), gridColor);
+                }
+            }
+            else if (x >= -1 && x <= state.gridWidth && y >= -1 && y <= state.gridHeight)
+            {
+                DrawCell(vec2i(x, y), borderColor);
+            }
+        }
+    }
+}
+
+vec2 Lerp(const vec2i &from, const vec2i &to, float alpha)
+{
+    return vec2(from.x + (to.x - from.x) * alpha, from.y + (to.y - from.y) * alpha);
+}
+
+// Draws the snake part way between the previous tick and the current one,
+// so it glides at any refresh rate while the simulation still steps once
+// per tick. Only the two ends move; every other segment sits where both
+// ticks agree.
+void DrawSnake(const GameSnapshot &state, float alpha)
+{
+    vec3 headColor(0.0f, 0.95f, 0.3f); // snake head color
+    size_t length = state.snake.size();
+
+    for (size_t i = 1; i < length; i++)
+    {
+        vec3 segmentcolor = SegmentColor(i, length);
+        DrawCell(state.snake[i], segmentcolor);
+
+        // the end of the tail slides out of the cell it is leaving
+        if (i == length - 1)
+        {
+            DrawCell(Lerp(state.previousTail, state.snake[i], alpha), segmentcolor);
+        }
+    }
+    DrawCell(Lerp(state.previousHead, state.snake[0], alpha), headColor); // draw snake
+    DrawCell(state.fruit, vec3(1.0f, 0.3f, 0.3f));                        // fruit color
+}
+
+// Just the two ends that slide between cells, over a board pass that has
+// drawn the rest of the body.
+void DrawSnakeEnds(const GameSnapshot &state, float alpha)
+{
+    vec3 headColor(0.0f, 0.95f, 0.3f); // as in DrawSnake
+    size_t length = state.snake.size();
+    DrawCell(Lerp(state.previousTail, state.snake[length - 1], alpha), SegmentColor(length - 1, length));
+    DrawCell(Lerp(state.previousHead, state.snake[0], alpha), headColor);
+}
+
+// Body segment `index` fades from green behind the head towards the tail.
+// BoardRenderer's shader repeats this.
+vec3 SegmentColor(size_t index, size_t length)
+{
+    vec3 bodyColor(0.0f, 0.7f, 0.1f); // snake body color
+    float factor = static_cast<float>(index) / length;
+    return vec3(bodyColor.r * (1.0f - factor) + 0.1f * factor,
+                bodyColor.g * (1.0f - factor) + 0.1f * factor,
+                bodyColor.b * (1.0f - factor));
+}
+
+void DrawScore(const GameSnapshot &state)
+{
+    DrawText(ScoreText(state.score));
+}
+
+// Only laid out again when the score changes.
+const TextMesh &ScoreText(int score)
+{
+    static TextMesh scoreText;
+    static int shownScore = -1;
+    if (score != shownScore)
+    {
+        scoreText = BuildText("SCORE: " + std::to_string(score), 0.0f, 0.9f, 0.012f, vec3(0.9f, 0.9f, 0.9f));
+        shownScore = score;
+    }
+    return scoreText;
+}
+
+void DrawGameOverBoard(float gameOverTime)
+{
+    for (int x = viewOrigin.x; x < viewOrigin.x + viewWidth; x++)
+    {
+        for (int y = viewOrigin.y; y < viewOrigin.y + viewHeight; y++)
+        {
+            DrawCell(vec2i(x, y), vec3(0.2f, 0.1f, 0.1f));
+        }
+    }
+    DrawAnimatedGameOverBorder(gameOverTime);
+}
+
+void DrawGameOver(const GameSnapshot &state)
+{
+    static const TextMesh winText = BuildText("YOU WIN", 0.0f, 0.2f, 0.025f, vec3(0.2f, 0.9f, 0.3f));
+    static const TextMesh lostText = BuildText("GAME OVER", 0.0f, 0.2f, 0.025f, vec3(0.9f, 0.2f, 0.2f));
+    static const TextMesh restartText =
+        BuildText("PRESS R TO RESTART", 0.0f, -0.2f, 0.015f, vec3(0.8f, 0.8f, 0.8f));
+
+    static TextMesh scoreText;
+    static int shownScore = -1;
+    if (state.score != shownScore)
+    {
+        scoreText = BuildText("SCORE : " + std::to_string(state.score), 0.0f, 0.0f, 0.018f,
+                              vec3(0.9f, 0.9f, 0.9f));
+        shownScore = state.score;
+    }
+
+    DrawText(state.gameWon ? winText : lostText);
+    DrawText(scoreText);
+    DrawText(restartText);
+}
+
+void DrawStartScreen()
+{
+    static const TextMesh lines[] = {
+        BuildText("SNAKE GAME", 0.0f, 0.3f, 0.025f, vec3(0.2f, 0.8f, 0.3f)), // title
+
+        BuildText("USE ARROW KEY TO MOVE", 0.0f, 0.0f, 0.012f, vec3(0.9f, 0.9f, 0.9f)),
+        BuildText("EAT THE RED FRUIT TO GROW", 0.0f, -0.1f, 0.012f, vec3(0.9f, 0.9f, 0.9f)),
+        BuildText("AVOID WALLS AND YOURSELF", 0.0f, -0.2f, 0.012f, vec3(0.9f, 0.9f, 0.9f)),
+        BuildText("PRESS ANY KEY TO START", 0.0f, -0.4f, 0.012f, vec3(0.8f, 0.8f, 0.2f)),
+    };
+    for (const TextMesh &line : lines)
+    {
+        DrawText(line);
+    }
+}
+
+// Scrolls the view so the head stays centred, clamped to the board edges.
+void UpdateView(const GameSnapshot &state)
+{
+    int width = std::min(state.gridWidth, MAX_VIEW_CELLS);
+    int height = std::min(state.gridHeight, MAX_VIEW_CELLS);
+
+    const vec2i &head = state.snake[0];
+    vec2i origin(std::max(0, std::min(head.x - width / 2, state.gridWidth - width)),
+                 std::max(0, std::min(head.y - height / 2, state.gridHeight - height)));
+
+    // the background only changes with the board or the visible window,
+    // which on boards that fit the screen never scrolls
+    vec2i grid(state.gridWidth, state.gridHeight);
+    if (width != viewWidth || height != viewHeight || !(origin == viewOrigin) || !(grid == viewGrid))
+    {
+        backgroundDirty = true;
+    }
+
+    viewWidth = width;
+    viewHeight = height;
+    viewOrigin = origin;
+    viewGrid = grid;
+    cellWidth = 2.0f / viewWidth;
+    cellHeight = 2.0f / viewHeight;
+}
+
+vec3 GameOverBorderColor(float gameOverTime)
+{
+    float pulse = 0.5f + 0.5f * sin(gameOverTime * 6.0f);
+    return vec3(0.6f + 0.4f * pulse, 0.1f, 0.1f);
+}
+
+void DrawAnimatedGameOverBorder(float gameOverTime)
+{
+    vec3 borderColor = GameOverBorderColor(gameOverTime);
+
+    int left = viewOrigin.x;
+    int right = viewOrigin.x + viewWidth - 1;
+    int bottom = viewOrigin.y;
+    int top = viewOrigin.y + viewHeight - 1;
+
+    for (int x = left; x <= right; x++)
+    {
+        DrawCell(vec2i(x, top), borderColor);
+        DrawCell(vec2i(x, bottom), borderColor);
+    }
+
+    for (int y = bottom; y <= top; y++)
+    {
+        DrawCell(vec2i(left, y), borderColor);
+        DrawCell(vec2i(right, y), borderColor);
+    }
+}
+
+// Left-aligned, unlike BuildText, and appended to a mesh that is rebuilt
+// every frame.
+void AppendText(TextMesh &mesh, const std::string &text, float left, float y, float scale,
+                const vec3 &color)
+{
+    float advance = (FONT_WITH + FONT_SPACING) * scale;
+    for (size_t i = 0; i < text.size(); i++)
+    {
+        AddChar(mesh, text[i], left + i * advance + FONT_WITH * scale / 2.0f, y, scale, color);
+    }
+}
+
+// With the overlay shown each phase is submitted on its own, so the GPU
+// time between its timestamps is that phase's alone.
+void EndPhase(FrameProfiler::Phase phase)
+{
+    if (overlayVisible)
+    {
+        backend->Submit(commands);
+        commands.Clear();
+        profiler.Mark(phase);
+    }
+}
+
+// Frame-time graphs and counters in the top-left corner, averaged over the
+// last second or so of profiled frames. GPU times arrive a few frames late.
+void DrawPerfOverlay()
+{
+    const int AVERAGE_FRAMES = 60;
+    const float GRAPH_MS = 33.3f; // top of both graphs
+    const float left = OVERLAY_LEFT, top = OVERLAY_TOP, width = OVERLAY_WIDTH;
+    const float graphHeight = 0.15f, lineHeight = 0.04f, textScale = 0.0045f;
+    const float barWidth = (width - 0.04f) / FrameProfiler::HISTORY;
+    const vec3 phaseColors[FrameProfiler::PHASE_COUNT] = {
+        vec3(0.4f, 0.4f, 0.9f), vec3(0.2f, 0.8f, 0.3f), vec3(0.9f, 0.9f, 0.9f), vec3(0.9f, 0.6f, 0.2f)};
+
+    float panelHeight = OVERLAY_HEIGHT;
+    commands.Cell(left + width / 2.0f, top - panelHeight / 2.0f, width, panelHeight, 0.0f, 0.0f, 0.0f);
+
+    // CPU frame time above, GPU time per phase stacked below; the line
+    // across each graph is 16.7 ms
+    float frameGraph = top - 0.02f - graphHeight;
+    float gpuGraph = frameGraph - 0.02f - graphHeight;
+    for (float base : {frameGraph, gpuGraph})
+    {
+        commands.Cell(left + width / 2.0f, base + graphHeight * 16.7f / GRAPH_MS, width - 0.04f, 0.004f,
+                      0.5f, 0.5f, 0.5f);
+    }
+
+    FrameProfiler::Sample sample, sum;
+    int averaged = 0, gpuAveraged = 0;
+    for (int age = 0; profiler.Get(age, sample); age++)
+    {
+        float x = left + 0.02f + (FrameProfiler::HISTORY - 0.5f - age) * barWidth;
+        float height = std::min(sample.frameMs, GRAPH_MS) / GRAPH_MS * graphHeight;
+        commands.Cell(x, frameGraph + height / 2.0f, barWidth, height, 0.9f, 0.8f, 0.2f);
+
+        float stacked = 0.0f;
+        for (int phase = 0; sample.hasGpu && phase < FrameProfiler::PHASE_COUNT; phase++)
+        {
+            float bottom = std::min(stacked, GRAPH_MS);
+            stacked += sample.gpuMs[phase];
+            float height = (std::min(stacked, GRAPH_MS) - bottom) / GRAPH_MS * graphHeight;
+            const vec3 &color = phaseColors[phase];
+            commands.Cell(x, gpuGraph + (bottom / GRAPH_MS * graphHeight) + height / 2.0f, barWidth,
+                          height, color.r, color.g, color.b);
+        }
+
+        if (age < AVERAGE_FRAMES)
+        {
+            averaged++;
+            sum.frameMs += sample.frameMs;
+            sum.drawCalls += sample.drawCalls;
+            sum.cells += sample.cells;
+            sum.stateCalls += sample.stateCalls;
+            sum.stateElided += sample.stateElided;
+            for (int phase = 0; phase < FrameProfiler::PHASE_COUNT; phase++)
+            {
+                sum.cpuMs[phase] += sample.cpuMs[phase];
+                sum.gpuMs[phase] += sample.hasGpu ? sample.gpuMs[phase] : 0.0f;
+            }
+            gpuAveraged += sample.hasGpu;
+        }
+    }
+
+    char lines[6][64];
+    float frameMs = sum.frameMs / std::max(1, averaged);
+    std::snprintf(lines[0], sizeof(lines[0]), "FRAME %.2fMS %.0fFPS", frameMs,
+                  frameMs > 0.0f ? 1000.0f / frameMs : 0.0f);
+    std::snprintf(lines[1], sizeof(lines[1]), "CPU B%.2f S%.2f T%.2f SW%.2f",
+                  sum.cpuMs[0] / std::max(1, averaged), sum.cpuMs[1] / std::max(1, averaged),
+                  sum.cpuMs[2] / std::max(1, averaged), sum.cpuMs[3] / std::max(1, averaged));
+    if (gpuAveraged > 0)
+    {
+        std::snprintf(lines[2], sizeof(lines[2]), "GPU B%.2f S%.2f T%.2f SW%.2f",
+                      sum.gpuMs[0] / gpuAveraged, sum.gpuMs[1] / gpuAveraged,
+                      sum.gpuMs[2] / gpuAveraged, sum.gpuMs[3] / gpuAveraged);
+    }
+    else
+    {
+        std::snprintf(lines[2], sizeof(lines[2]), "GPU -");
+    }
+    std::snprintf(lines[3], sizeof(lines[3]), "UPDATE %.3fMS TICKS %.1fHZ", overlayHost.updateMs,
+                  overlayHost.tickRate);
+    std::snprintf(lines[4], sizeof(lines[4]), "DRAWS %u CELLS %u",
+                  sum.drawCalls / std::max(1, averaged), sum.cells / std::max(1, averaged));
+    std::snprintf(lines[5], sizeof(lines[5]), "GL STATE %u ELIDED %u",
+                  sum.stateCalls / std::max(1, averaged), sum.stateElided / std::max(1, averaged));
+
+    static TextMesh text;
+    text.clear();
+    float y = gpuGraph - 0.02f - lineHeight / 2.0f;
+    for (const char *line : lines)
+    {
+        AppendText(text, line, left + 0.02f, y, textScale, vec3(0.9f, 0.9f, 0.9f));
+        y -= lineHeight;
+    }
+    DrawText(text);
+}
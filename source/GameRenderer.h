@@ -0,0 +1,54 @@
+#pragma once
+
+#include <ostream>
+
+#include "GLExtensions.h"
+#include "Game.h"
+#include "RenderBackend.h"
+
+// Draws the game from a GameSnapshot: the board, snake and score, and the
+// start and game-over screens, as quads sent to a RenderBackend: the GL
+// CellRenderer, or a SoftwareRenderer where there is no GPU. Used by the
+// windowed game and by the offscreen renderer. Everything runs on one
+// thread, for GL the one that owns the context, and presenting the frame
+// is left to the caller.
+
+// Loads GL through `load` and builds the GPU resources. False, with the
+// reason on std::cerr, if the context is older than GL 3.3 or a shader
+// fails. With `boardPass` the GL backend draws the board from a grid-state
+// texture in one pass (see BoardRenderer), falling back to quads if that
+// cannot be set up. With `damageTracking` the GL backend keeps the frame
+// between calls and redraws only what changed: the sliding snake ends, the
+// body after a move, the fruit, the score, the pulsing game-over border
+// and the overlay.
+bool InitGameRenderer(GLADloadproc load, bool persistentMapping = true, bool boardPass = false,
+                      bool damageTracking = false);
+void ShutdownGameRenderer();
+
+// sinceSnapshot carries the snake and the game-over pulse forward from
+// when the snapshot was taken; 0 draws it exactly as it was. Draws with the
+// GL backend that InitGameRenderer set up.
+void RenderGame(const GameSnapshot &state, float sinceSnapshot, int framebufferWidth,
+                int framebufferHeight);
+// The same into any backend; the software one needs no InitGameRenderer.
+void RenderGame(RenderBackend &target, const GameSnapshot &state, float sinceSnapshot,
+                int framebufferWidth, int framebufferHeight);
+
+// Numbers from the thread that runs the simulation, for the overlay.
+struct HostStats
+{
+    float updateMs = 0.0f; // the last GameState::Update
+    float tickRate = 0.0f; // simulation ticks per second
+};
+
+// Shows or hides the performance overlay (frame-time graphs, phase times,
+// draw counts, tick rate) from the next frame on. Frames are profiled only
+// while it is shown; with the GL backend that includes GPU timer queries.
+void SetPerfOverlay(bool visible, const HostStats &host);
+// Call right after presenting a frame from RenderGame, so the overlay can
+// time the swap.
+void FramePresented();
+
+// Draw calls, CPU time and streaming totals over all frames rendered,
+// counted against the backend used last.
+void PrintRenderStats(std::ostream &out);
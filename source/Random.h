@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+
+// Small, fast PCG32 generator (O'Neill's XSH-RR variant) with our own
+// bounded-range mapping. Unlike std::mt19937 fed through
+// std::uniform_int_distribution, whose mapping is left to the standard
+// library, the output here is fully specified, so the same seed gives the
+// same game on every compiler and platform. Each (seed, stream) pair is an
+// independent sequence, which gives per-game and per-thread streams.
+class Random
+{
+public:
+    explicit Random(uint64_t seed = 0, uint64_t stream = 0)
+    {
+        Seed(seed, stream);
+    }
+
+    void Seed(uint64_t seed, uint64_t stream = 0)
+    {
+        state = 0;
+        increment = (stream << 1) | 1;
+        Next();
+        state += seed;
+        Next();
+    }
+
+    uint32_t Next()
+    {
+        uint64_t old = state;
+        state = old * 6364136223846793005ULL + increment;
+        uint32_t xorshifted = static_cast<uint32_t>(((old >> 18) ^ old) >> 27);
+        uint32_t rotation = static_cast<uint32_t>(old >> 59);
+        return (xorshifted >> rotation) | (xorshifted << ((0u - rotation) & 31));
+    }
+
+    // Uniform in [0, bound), bound > 0. Lemire's multiply-shift, rejecting
+    // the few low products that would bias the result.
+    uint32_t Below(uint32_t bound)
+    {
+        uint64_t product = uint64_t(Next()) * bound;
+        uint32_t low = static_cast<uint32_t>(product);
+        if (low < bound)
+        {
+            uint32_t threshold = (0u - bound) % bound;
+            while (low < threshold)
+            {
+                product = uint64_t(Next()) * bound;
+                low = static_cast<uint32_t>(product);
+            }
+        }
+        return static_cast<uint32_t>(product >> 32);
+    }
+
+    // Uniform in [low, high], inclusive.
+    int Range(int low, int high)
+    {
+        return low + static_cast<int>(Below(static_cast<uint32_t>(high - low) + 1));
+    }
+
+private:
+    uint64_t state;
+    uint64_t increment;
+};
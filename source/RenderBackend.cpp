@@ -0,0 +1,47 @@
+#include "RenderBackend.h"
+
+#include <algorithm>
+
+#include "RenderCommands.h"
+
+void RenderBackend::Submit(const RenderCommands &commands)
+{
+    const std::vector<RenderCommands::Command> &list = commands.Commands();
+    order.resize(list.size());
+    for (size_t i = 0; i < list.size(); i++)
+    {
+        order[i] = static_cast<uint32_t>(i);
+    }
+    // keys are unique; a frame recorded layer by layer, each one's pipelines
+    // in their order, is sorted already
+    std::sort(order.begin(), order.end(),
+              [&list](uint32_t a, uint32_t b) { return list[a].key < list[b].key; });
+
+    for (uint32_t index : order)
+    {
+        const RenderCommands::Command &command = list[index];
+        switch (command.kind)
+        {
+        case RenderCommands::Cells:
+            Add(commands.Instances() + command.first, command.count);
+            break;
+        case RenderCommands::Glyphs:
+            Add(command.glyphs, command.count);
+            break;
+        case RenderCommands::StoreBackground:
+            Flush();
+            Add(commands.Instances() + command.first, command.count);
+            StoreBackground();
+            break;
+        case RenderCommands::DrawBackground:
+            Flush();
+            DrawBackground();
+            break;
+        case RenderCommands::Pass:
+            Flush();
+            commands.RunPass(command.first);
+            break;
+        }
+    }
+    Flush();
+}
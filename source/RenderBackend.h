@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class RenderCommands;
+
+// One quad of the frame: centre and size in NDC, and its colour.
+struct CellInstance
+{
+    float x, y;
+    float width, height;
+    float r, g, b;
+};
+
+// Where RenderGame sends a frame. Everything on screen is an axis-aligned
+// quad (board cells, snake, text pixels), queued with Add in painter's
+// order and drawn by Flush, or recorded into RenderCommands and handed over
+// with Submit. Cells that rarely change can be kept in a background layer
+// that the backend may hold on to between frames.
+class RenderBackend
+{
+public:
+    RenderBackend() : drawCalls(0), instances(0), backgroundBuilds(0) {}
+    virtual ~RenderBackend() {}
+
+    // Starts a frame of width x height pixels cleared to the colour. True
+    // when the size differs from the previous frame's.
+    virtual bool BeginFrame(int width, int height, float r, float g, float b) = 0;
+
+    void Add(float x, float y, float width, float height, float r, float g, float b)
+    {
+        queued.push_back({x, y, width, height, r, g, b});
+    }
+    void Add(const CellInstance *cells, size_t count)
+    {
+        queued.insert(queued.end(), cells, cells + count);
+    }
+    // Draws and clears everything queued since the last Flush.
+    virtual void Flush() = 0;
+    // Draws a recorded buffer in key order, between BeginFrame and EndFrame.
+    // Sorting brings each layer's quads together, so they go into one Flush.
+    void Submit(const RenderCommands &commands);
+    // Call after the last Flush of a frame.
+    virtual void EndFrame() = 0;
+
+    // Moves everything queued so far into the background layer, replacing
+    // the old one, without drawing it.
+    virtual void StoreBackground() = 0;
+    virtual void DrawBackground() = 0;
+
+    unsigned long long drawCalls;        // over the whole run
+    unsigned long long instances;        // quads drawn over the whole run
+    unsigned long long backgroundBuilds; // StoreBackground calls
+
+protected:
+    std::vector<CellInstance> queued;
+
+private:
+    std::vector<uint32_t> order; // Submit's sorted commands, kept between frames
+};
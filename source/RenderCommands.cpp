@@ -0,0 +1,115 @@
+#include "RenderCommands.h"
+
+#include <algorithm>
+
+namespace
+{
+const int SEQUENCE_BITS = 32 - RenderCommands::LAYER_BITS - RenderCommands::PIPELINE_BITS;
+const int LAYER_SHIFT = SEQUENCE_BITS + RenderCommands::PIPELINE_BITS;
+
+// Quads from the array and from text meshes share a pipeline, and a batch.
+uint32_t Key(uint32_t layer, RenderCommands::Kind kind, size_t sequence)
+{
+    uint32_t pipeline = std::min<uint32_t>(kind, RenderCommands::Cells);
+    return (layer << LAYER_SHIFT) | (pipeline << SEQUENCE_BITS) | static_cast<uint32_t>(sequence);
+}
+}
+
+RenderCommands::RenderCommands()
+    : layer(0), inBackground(false), backgroundFirst(0)
+{
+}
+
+void RenderCommands::Clear()
+{
+    commands.clear();
+    instances.clear();
+    passes.clear();
+    layer = 0;
+    inBackground = false;
+}
+
+void RenderCommands::SetLayer(uint8_t value)
+{
+    layer = value;
+}
+
+void RenderCommands::Push(Kind kind, uint32_t first, uint32_t count, const CellInstance *glyphs)
+{
+    commands.push_back({Key(layer, kind, commands.size()), kind, first, count, glyphs});
+}
+
+void RenderCommands::Cell(float x, float y, float width, float height, float r, float g, float b)
+{
+    uint32_t index = static_cast<uint32_t>(instances.size());
+    instances.push_back({x, y, width, height, r, g, b});
+    if (inBackground)
+    {
+        return;
+    }
+
+    // quads recorded one after another on a layer stay one command
+    if (!commands.empty())
+    {
+        Command &last = commands.back();
+        if (last.kind == Cells && last.key >> LAYER_SHIFT == layer && last.first + last.count == index)
+        {
+            last.count++;
+            return;
+        }
+    }
+    Push(Cells, index, 1);
+}
+
+void RenderCommands::Text(const std::vector<CellInstance> &mesh)
+{
+    if (!mesh.empty())
+    {
+        Push(Glyphs, 0, static_cast<uint32_t>(mesh.size()), mesh.data());
+    }
+}
+
+void RenderCommands::BeginBackground()
+{
+    inBackground = true;
+    backgroundFirst = static_cast<uint32_t>(instances.size());
+}
+
+void RenderCommands::EndBackground()
+{
+    inBackground = false;
+    Push(StoreBackground, backgroundFirst, static_cast<uint32_t>(instances.size()) - backgroundFirst);
+}
+
+void RenderCommands::Background()
+{
+    Push(DrawBackground, 0, 0);
+}
+
+void RenderCommands::Draw(std::function<void()> draw)
+{
+    passes.push_back(std::move(draw));
+    Push(Pass, static_cast<uint32_t>(passes.size() - 1), 0);
+}
+
+void RenderCommands::Append(const RenderCommands &other)
+{
+    uint32_t instanceBase = static_cast<uint32_t>(instances.size());
+    uint32_t passBase = static_cast<uint32_t>(passes.size());
+    instances.insert(instances.end(), other.instances.begin(), other.instances.end());
+    passes.insert(passes.end(), other.passes.begin(), other.passes.end());
+
+    for (Command command : other.commands)
+    {
+        if (command.kind == Pass)
+        {
+            command.first += passBase;
+        }
+        else if (command.kind != Glyphs)
+        {
+            command.first += instanceBase;
+        }
+        command.key = Key(command.key >> LAYER_SHIFT, command.kind, commands.size());
+        commands.push_back(command);
+    }
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "RenderBackend.h"
+
+// A frame recorded as a list of compact commands instead of calls into a
+// backend, for RenderBackend::Submit to sort, batch and draw. Runs of
+// quads are kept as ranges of one array, and text as a pointer to its
+// mesh, so recording copies no more than it has to.
+//
+// Every command carries a key: the layer it was recorded on in the top
+// bits, then the pipeline it draws with, then its place in the recording.
+// Submit draws in key order, so a layer can be recorded at any point and
+// still lands above the ones below it. Within a layer, whatever brings its
+// own pipeline (the background layer, then passes) is drawn first, and all
+// of the layer's quads go on top in one batch, each group in the order it
+// was recorded.
+//
+// Nothing here touches GL or shared state: any thread can record a buffer
+// of its own, one thread at a time, and hand it to the thread that
+// submits, which Appends it to the frame.
+class RenderCommands
+{
+public:
+    // In the order their pipelines are drawn within a layer.
+    enum Kind : uint8_t
+    {
+        StoreBackground, // quads that replace the background layer, not drawn
+        DrawBackground,
+        Pass,            // a callback that draws by itself, e.g. another shader
+        Cells,           // quads from the buffer's own array
+        Glyphs,          // quads of a text mesh held by the recorder, as Cells
+    };
+
+    struct Command
+    {
+        uint32_t key;
+        Kind kind;
+        uint32_t first; // into Instances() for quads, into the passes for a Pass
+        uint32_t count;
+        const CellInstance *glyphs; // Glyphs only; the mesh has to outlive Submit
+    };
+
+    static const int LAYER_BITS = 8;
+    static const int PIPELINE_BITS = 2;
+
+    RenderCommands();
+
+    // Forgets the frame, keeping the memory for the next one.
+    void Clear();
+
+    // Layer of what is recorded from here on, 0 is drawn first.
+    void SetLayer(uint8_t layer);
+
+    void Cell(float x, float y, float width, float height, float r, float g, float b);
+    void Text(const std::vector<CellInstance> &mesh);
+    // Quads recorded between these two become the background layer.
+    void BeginBackground();
+    void EndBackground();
+    void Background();
+    // Runs `draw` on the submitting thread, after the quads before it.
+    void Draw(std::function<void()> draw);
+
+    // Adds a buffer recorded elsewhere, on the layers it was recorded on and
+    // after everything already on them.
+    void Append(const RenderCommands &other);
+
+    const std::vector<Command> &Commands() const { return commands; }
+    const CellInstance *Instances() const { return instances.data(); }
+    void RunPass(uint32_t index) const { passes[index](); }
+
+private:
+    void Push(Kind kind, uint32_t first, uint32_t count, const CellInstance *glyphs = nullptr);
+
+    std::vector<Command> commands;
+    std::vector<CellInstance> instances;
+    std::vector<std::function<void()>> passes;
+    uint32_t layer;
+    bool inBackground;
+    uint32_t backgroundFirst; // first instance of the background being recorded
+};
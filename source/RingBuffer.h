@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+// Ring buffer used for the snake body. Element 0 is the front (the head)
+// and size() - 1 the back (the tail), so moving the snake is one push_front
+// plus one pop_back, both O(1) with no shifting. Size the initial capacity
+// to the board area on small boards; on large boards it starts smaller and
+// doubles when full, which keeps pushes amortised O(1).
+template <typename T>
+class RingBuffer
+{
+public:
+    explicit RingBuffer(size_t capacity = 0)
+        : data(capacity), first(0), count(0)
+    {
+    }
+
+    void push_front(const T &value)
+    {
+        if (count == data.size())
+        {
+            Grow();
+        }
+        first = (first == 0 ? data.size() : first) - 1;
+        data[first] = value;
+        count++;
+    }
+
+    void push_back(const T &value)
+    {
+        if (count == data.size())
+        {
+            Grow();
+        }
+        data[Wrap(first + count)] = value;
+        count++;
+    }
+
+    void pop_back()
+    {
+        assert(count > 0);
+        count--;
+    }
+
+    void clear()
+    {
+        first = 0;
+        count = 0;
+    }
+
+    T &operator[](size_t i) { return data[Wrap(first + i)]; }
+    const T &operator[](size_t i) const { return data[Wrap(first + i)]; }
+
+    T &front() { return (*this)[0]; }
+    const T &front() const { return (*this)[0]; }
+    T &back() { return (*this)[count - 1]; }
+    const T &back() const { return (*this)[count - 1]; }
+
+    size_t size() const { return count; }
+    size_t capacity() const { return data.size(); }
+    bool empty() const { return count == 0; }
+    bool full() const { return count == data.size(); }
+
+private:
+    void Grow()
+    {
+        std::vector<T> grown(data.empty() ? 16 : data.size() * 2);
+        for (size_t i = 0; i < count; i++)
+        {
+            grown[i] = (*this)[i];
+        }
+        data.swap(grown);
+        first = 0;
+    }
+
+    size_t Wrap(size_t i) const
+    {
+        return i >= data.size() ? i - data.size() : i;
+    }
+
+    std::vector<T> data;
+    size_t first;
+    size_t count;
+};
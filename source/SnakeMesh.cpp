@@ -0,0 +1,342 @@
+#include "SnakeMesh.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+
+namespace
+{
+const size_t INITIAL_SLOTS = 1024; // doubled whenever the snake outgrows the ring
+// Past this the snake is left to the quad path; the buffer would be 96 MB.
+const size_t MAX_SLOTS = size_t(1) << 22;
+// Larger gaps between updates are cheaper to rebuild than to replay.
+const unsigned long long MAX_REPLAYED_MOVES = 64;
+
+// Places and colours each slot as DrawCell and DrawSnake would.
+const char *vertexShaderSource = R"(
+#version 330 core
+layout (location = 0) in ivec2 aCell;
+layout (location = 1) in uint aStamp;
+
+uniform ivec2 uViewOrigin;
+uniform vec2 uCellSize; // in NDC
+uniform uint uHeadStamp;
+uniform float uLength;
+
+out vec3 vColor;
+
+void main()
+{
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) - 0.5;
+    vec2 cell = vec2(aCell - uViewOrigin);
+    vec2 centre = -1.0 + cell * uCellSize + uCellSize * 0.5;
+    gl_Position = vec4(corner * (uCellSize * 0.9) + centre, 0.0, 1.0);
+
+    // the segment index is how many ticks ago the head entered the cell
+    float factor = float(uHeadStamp - aStamp) / uLength;
+    vColor = vec3(0.0 * (1.0 - factor) + 0.1 * factor,
+                  0.7 * (1.0 - factor) + 0.1 * factor,
+                  0.1 * (1.0 - factor));
+}
+
+)";
+
+const char *fragmentShaderSource = R"(
+#version 330 core
+in vec3 vColor;
+out vec4 FragColor;
+
+void main()
+{
+    FragColor = vec4(vColor, 1.0);
+}
+
+)";
+
+GLuint CompileShader(GLenum type, const char *source, const char *name)
+{
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint success;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success)
+    {
+        char infoLog[512];
+        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+        std::cerr << name << " shader error:\n" << infoLog << std::endl;
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+}
+
+SnakeMesh::SnakeMesh()
+    : slotsUploaded(0), fullUploads(0), stallSeconds(0.0), program(0), uniformViewOrigin(-1),
+      uniformCellSize(-1), uniformHeadStamp(-1), uniformLength(-1), copy(0), prepared(false), capacity(0),
+      written(0), length(0), moves(0), games(0)
+{
+}
+
+bool SnakeMesh::Init()
+{
+    GLuint vertexShader = CompileShader(GL_VERTEX_SHADER, vertexShaderSource, "Snake vertex");
+    GLuint fragmentShader = CompileShader(GL_FRAGMENT_SHADER, fragmentShaderSource, "Snake fragment");
+    if (!vertexShader || !fragmentShader)
+    {
+        return false;
+    }
+
+    program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    GLint success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        char infoLog[512];
+        glGetProgramInfoLog(program, 512, nullptr, infoLog);
+        std::cerr << "Snake shader link error:\n" << infoLog << std::endl;
+        return false;
+    }
+
+    uniformViewOrigin = glGetUniformLocation(program, "uViewOrigin");
+    uniformCellSize = glGetUniformLocation(program, "uCellSize");
+    uniformHeadStamp = glGetUniformLocation(program, "uHeadStamp");
+    uniformLength = glGetUniformLocation(program, "uLength");
+
+    for (Copy &ring : copies)
+    {
+        glGenVertexArrays(1, &ring.VAO);
+    }
+    Allocate(INITIAL_SLOTS);
+    length = 0; // the first Update rebuilds
+    return true;
+}
+
+void SnakeMesh::Shutdown()
+{
+    Release();
+    for (Copy &ring : copies)
+    {
+        glState.DeleteVertexArray(ring.VAO);
+        ring = Copy();
+    }
+    glState.DeleteProgram(program);
+    program = 0;
+    capacity = length = 0;
+    copy = 0;
+    prepared = false;
+    slots.clear();
+}
+
+// Fresh buffers of `count` slots each, none of them holding anything yet.
+void SnakeMesh::Allocate(size_t count)
+{
+    Release();
+    capacity = count;
+    slots.assign(capacity, Slot());
+
+    for (Copy &ring : copies)
+    {
+        glGenBuffers(1, &ring.buffer);
+        glState.BindArrayBuffer(ring.buffer);
+        glBufferData(GL_ARRAY_BUFFER, 2 * capacity * sizeof(Slot), nullptr, GL_DYNAMIC_DRAW);
+
+        glState.BindVertexArray(ring.VAO);
+        glState.VertexAttribIPointer(0, ring.buffer, 2, GL_INT, sizeof(Slot), offsetof(Slot, x));
+        glState.VertexAttribIPointer(1, ring.buffer, 1, GL_UNSIGNED_INT, sizeof(Slot), offsetof(Slot, stamp));
+        glEnableVertexAttribArray(0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribDivisor(0, 1);
+        glVertexAttribDivisor(1, 1);
+    }
+}
+
+// Drops the buffers; the driver keeps them until draws already issued are done.
+void SnakeMesh::Release()
+{
+    for (Copy &ring : copies)
+    {
+        if (ring.fence)
+        {
+            glDeleteSync(ring.fence);
+            ring.fence = nullptr;
+        }
+        if (ring.buffer)
+        {
+            glState.DeleteBuffer(ring.buffer);
+            ring.buffer = 0;
+        }
+        ring.current = false;
+    }
+}
+
+bool SnakeMesh::Update(const GameSnapshot &state)
+{
+    if (state.snake.empty() || state.snake.size() > MAX_SLOTS)
+    {
+        return false;
+    }
+
+    unsigned long long moved = state.moves - moves;
+    if (length == 0 || state.games != games || state.moves < moves || moved > MAX_REPLAYED_MOVES ||
+        moved >= state.snake.size() || state.snake.size() > capacity)
+    {
+        Rebuild(state);
+        return true;
+    }
+
+    // the new heads from the oldest; the tail falls out of the window
+    for (size_t i = moved; i-- > 0;)
+    {
+        Write(state.snake[i]);
+    }
+    length = state.snake.size();
+    moves = state.moves;
+
+    const Slot &head = slots[(written - 1) % capacity];
+    const Slot &tail = slots[(written - length) % capacity];
+    if (head.x != state.snake.front().x || head.y != state.snake.front().y ||
+        tail.x != state.snake.back().x || tail.y != state.snake.back().y)
+    {
+        Rebuild(state); // out of step, e.g. a missed restart
+    }
+    return true;
+}
+
+void SnakeMesh::Rebuild(const GameSnapshot &state)
+{
+    if (state.snake.size() > capacity)
+    {
+        size_t grown = capacity;
+        while (grown < state.snake.size())
+        {
+            grown *= 2;
+        }
+        Allocate(grown);
+    }
+
+    // the tail gets slot 0, so the whole snake goes up in two writes
+    length = state.snake.size();
+    for (size_t i = 0; i < length; i++)
+    {
+        const vec2i &cell = state.snake[length - 1 - i];
+        slots[i] = {cell.x, cell.y, static_cast<uint32_t>(i)};
+    }
+    written = static_cast<uint32_t>(length);
+    moves = state.moves;
+    games = state.games;
+
+    // stamps start over, so every buffer has to be written whole
+    for (Copy &ring : copies)
+    {
+        ring.current = false;
+    }
+}
+
+// Appends the head's new cell; the buffers pick it up when next drawn.
+void SnakeMesh::Write(const vec2i &cell)
+{
+    slots[written % capacity] = {cell.x, cell.y, written};
+    written++;
+}
+
+// Waits until the GPU is done with the buffer, then writes it the slots
+// of the window it is missing.
+void SnakeMesh::Prepare(Copy &ring)
+{
+    if (ring.fence)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        GLenum result = glClientWaitSync(ring.fence, 0, 0);
+        while (result == GL_TIMEOUT_EXPIRED)
+        {
+            result = glClientWaitSync(ring.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        }
+        stallSeconds += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+        glDeleteSync(ring.fence);
+        ring.fence = nullptr;
+    }
+
+    // slots before the window are never read again, whatever they hold
+    uint32_t windowStart = written - static_cast<uint32_t>(length);
+    uint32_t first = windowStart;
+    if (ring.current)
+    {
+        first = std::max(ring.written, windowStart);
+    }
+    else
+    {
+        fullUploads++;
+    }
+    UploadSlots(ring, first, written - first);
+    ring.written = written;
+    ring.current = true;
+}
+
+// Slots with stamps first to first + count - 1, to both their places.
+void SnakeMesh::UploadSlots(Copy &ring, size_t first, size_t count)
+{
+    glState.BindArrayBuffer(ring.buffer);
+    while (count > 0)
+    {
+        size_t index = first % capacity;
+        size_t run = std::min(count, capacity - index); // up to the end of the ring
+        glBufferSubData(GL_ARRAY_BUFFER, index * sizeof(Slot), run * sizeof(Slot), &slots[index]);
+        glBufferSubData(GL_ARRAY_BUFFER, (index + capacity) * sizeof(Slot), run * sizeof(Slot), &slots[index]);
+        slotsUploaded += run;
+        first += run;
+        count -= run;
+    }
+}
+
+size_t SnakeMesh::Draw(const vec2i &viewOrigin, float cellWidth, float cellHeight)
+{
+    if (length < 2)
+    {
+        return 0;
+    }
+
+    Copy &ring = copies[copy];
+    if (!prepared)
+    {
+        Prepare(ring);
+        prepared = true;
+    }
+
+    // segments 1 to length - 1: the window of slots just before the head's
+    size_t count = length - 1;
+    size_t start = (written - length) % capacity;
+
+    glState.UseProgram(program);
+    glState.Uniform2i(uniformViewOrigin, viewOrigin.x, viewOrigin.y);
+    glState.Uniform2f(uniformCellSize, cellWidth, cellHeight);
+    glState.Uniform1ui(uniformHeadStamp, written - 1);
+    glState.Uniform1f(uniformLength, float(length));
+    glState.BindVertexArray(ring.VAO);
+
+    // without base-instance draws the attributes are pointed at the window
+    glState.VertexAttribIPointer(0, ring.buffer, 2, GL_INT, sizeof(Slot), start * sizeof(Slot) + offsetof(Slot, x));
+    glState.VertexAttribIPointer(1, ring.buffer, 1, GL_UNSIGNED_INT, sizeof(Slot),
+                                 start * sizeof(Slot) + offsetof(Slot, stamp));
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(count));
+    return count;
+}
+
+void SnakeMesh::EndFrame()
+{
+    if (prepared)
+    {
+        copies[copy].fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        copy = (copy + 1) % COPIES;
+        prepared = false;
+    }
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "GLStateCache.h"
+#include "Game.h"
+#include "StreamBuffer.h"
+
+// The snake's body kept on the GPU as a ring of instance slots, one for
+// each cell the head has entered, instead of a quad per segment queued
+// every frame. A tick writes the new head's slot; the tail is retired by
+// moving where the draw starts, so the upload per tick is one slot however
+// long the snake is, and nothing at all between ticks. The shader places
+// each slot from its cell and colours it from how many ticks ago the head
+// was there, the gradient DrawSnake uses.
+//
+// Each slot is stored twice, at i and i + capacity, so the newest slots
+// are always one contiguous range and one draw covers them. The sliding
+// head and tail ends are not included, they are drawn as quads on top.
+//
+// The ring is kept in one buffer per frame in flight, as StreamBuffer's
+// regions are, so a frame only ever writes a buffer the GPU is done with.
+// Each buffer catches up on the slots written since it was last drawn
+// from the copy kept here.
+class SnakeMesh
+{
+public:
+    static const int COPIES = StreamBuffer::FRAMES_IN_FLIGHT;
+
+    SnakeMesh();
+
+    // Needs a current GL 3.3 context; false if the shaders fail to build.
+    bool Init();
+    void Shutdown();
+
+    // Brings the ring up to date with `state`, without touching GL. False
+    // if the snake is too long to keep here; the caller then has to draw
+    // it itself.
+    bool Update(const GameSnapshot &state);
+
+    // Draws body segments 1 to length - 1 with DrawCell's placement for the
+    // view, and returns how many were drawn. May be called more than once
+    // in a frame, e.g. once per damaged rectangle.
+    size_t Draw(const vec2i &viewOrigin, float cellWidth, float cellHeight);
+    // Fences the buffer this frame drew from and moves on to the next.
+    void EndFrame();
+
+    unsigned long long slotsUploaded; // over the whole run, to all the buffers
+    unsigned long long fullUploads;   // buffers written whole, after a restart or a gap
+    double stallSeconds;              // waiting for the GPU to free a buffer
+
+private:
+    struct Slot
+    {
+        int32_t x, y;
+        uint32_t stamp; // the head's tick when it entered the cell
+    };
+
+    // One buffer of the ring and the VAO that reads it.
+    struct Copy
+    {
+        GLuint buffer = 0;
+        GLuint VAO = 0;
+        GLsync fence = nullptr;
+        bool current = false; // holds every slot up to `written`
+        uint32_t written = 0; // slots it holds, in the count of the same name
+    };
+
+    void Allocate(size_t slots);
+    void Release();
+    void Rebuild(const GameSnapshot &state);
+    void Write(const vec2i &cell);
+    void Prepare(Copy &copy);
+    void UploadSlots(Copy &copy, size_t first, size_t count);
+
+    GLuint program;
+    GLint uniformViewOrigin, uniformCellSize, uniformHeadStamp, uniformLength;
+    Copy copies[COPIES];
+    int copy;      // the one this frame draws from
+    bool prepared; // it is up to date for this frame
+
+    size_t capacity;           // slots in the ring, each buffer holds twice as many
+    std::vector<Slot> slots;   // what the ring holds, without the mirror
+    uint32_t written;          // slots written since the last rebuild, the next stamp
+    size_t length;             // the snake's length in the last snapshot
+    unsigned long long moves, games; // of the snapshot last applied
+};
@@ -0,0 +1,171 @@
+#include "SoftwareRenderer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SNAKE_SOFTWARE_SSE2
+#endif
+
+namespace
+{
+// RGBA bytes in memory order, whatever the endianness.
+uint32_t PackColor(float r, float g, float b)
+{
+    const float channels[4] = {r, g, b, 1.0f};
+    uint8_t bytes[4];
+    for (int i = 0; i < 4; i++)
+    {
+        // round half to even, as GL's float to unorm conversion does
+        float value = std::min(std::max(channels[i], 0.0f), 1.0f) * 255.0f;
+        bytes[i] = static_cast<uint8_t>(std::nearbyint(value));
+    }
+    uint32_t color;
+    std::memcpy(&color, bytes, sizeof(color));
+    return color;
+}
+
+// Quad spans are as wide as a cell or a text pixel, so four pixels per
+// store plus a short tail.
+void FillSpan(uint32_t *span, int count, uint32_t color)
+{
+    int i = 0;
+#ifdef SNAKE_SOFTWARE_SSE2
+    __m128i value = _mm_set1_epi32(static_cast<int>(color));
+    for (; i + 4 <= count; i += 4)
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(span + i), value);
+    }
+#endif
+    for (; i < count; i++)
+    {
+        span[i] = color;
+    }
+}
+
+// First pixel whose centre is at or past `edge`, in pixels. The edge is
+// snapped to 1/256 of a pixel first, as GL rasterizers do, so cells whose
+// edges land on pixel centres split the same way as on the GPU.
+int FirstCovered(float edge, int limit)
+{
+    edge = std::nearbyint(edge * 256.0f) / 256.0f;
+    return std::min(std::max(static_cast<int>(std::ceil(edge - 0.5f)), 0), limit);
+}
+}
+
+SoftwareRenderer::SoftwareRenderer() : width(0), height(0), clearColor(0), clearPending(false), backgroundClear(0)
+{
+}
+
+bool SoftwareRenderer::BeginFrame(int frameWidth, int frameHeight, float r, float g, float b)
+{
+    bool resized = frameWidth != width || frameHeight != height;
+    if (resized)
+    {
+        width = frameWidth;
+        height = frameHeight;
+        pixels.assign(size_t(width) * height, 0);
+        background.clear();
+    }
+
+    // cleared on first use, a background copy covers the whole frame anyway
+    clearColor = PackColor(r, g, b);
+    clearPending = true;
+    return resized;
+}
+
+void SoftwareRenderer::Clear()
+{
+    if (clearPending)
+    {
+        FillSpan(pixels.data(), width * height, clearColor);
+        clearPending = false;
+    }
+}
+
+void SoftwareRenderer::Fill(std::vector<uint32_t> &target, const CellInstance &cell)
+{
+    // NDC to pixels as the GL viewport transform does it
+    float halfWidth = width * 0.5f;
+    float halfHeight = height * 0.5f;
+    int left = FirstCovered((cell.x - cell.width * 0.5f) * halfWidth + halfWidth, width);
+    int right = FirstCovered((cell.x + cell.width * 0.5f) * halfWidth + halfWidth, width);
+    int bottom = FirstCovered((cell.y - cell.height * 0.5f) * halfHeight + halfHeight, height);
+    int top = FirstCovered((cell.y + cell.height * 0.5f) * halfHeight + halfHeight, height);
+    if (left >= right || bottom >= top)
+    {
+        return;
+    }
+
+    uint32_t color = PackColor(cell.r, cell.g, cell.b);
+    for (int y = bottom; y < top; y++)
+    {
+        FillSpan(target.data() + size_t(y) * width + left, right - left, color);
+    }
+}
+
+void SoftwareRenderer::Flush()
+{
+    if (queued.empty())
+    {
+        return;
+    }
+
+    Clear();
+    for (const CellInstance &cell : queued)
+    {
+        Fill(pixels, cell);
+    }
+
+    drawCalls++;
+    instances += queued.size();
+    queued.clear();
+}
+
+void SoftwareRenderer::EndFrame()
+{
+    Clear(); // nothing was drawn
+}
+
+void SoftwareRenderer::StoreBackground()
+{
+    backgroundClear = clearColor;
+    background.assign(size_t(width) * height, clearColor);
+    for (const CellInstance &cell : queued)
+    {
+        Fill(background, cell);
+    }
+
+    backgroundCells.swap(queued);
+    backgroundBuilds++;
+    queued.clear();
+}
+
+void SoftwareRenderer::DrawBackground()
+{
+    if (background.size() != pixels.size())
+    {
+        return;
+    }
+
+    if (clearPending && backgroundClear == clearColor)
+    {
+        // the layer already holds the clear colour, so it replaces the frame
+        std::memcpy(pixels.data(), background.data(), pixels.size() * sizeof(uint32_t));
+        clearPending = false;
+    }
+    else
+    {
+        // drawn over what is already there, as on the GPU
+        Clear();
+        for (const CellInstance &cell : backgroundCells)
+        {
+            Fill(pixels, cell);
+        }
+    }
+
+    drawCalls++;
+    instances += backgroundCells.size();
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "RenderBackend.h"
+
+// The CPU backend, for machines without a GPU: fills each quad straight
+// into an RGBA8 framebuffer in memory. Quads cover the pixels whose centres
+// fall inside them, with edges and colours rounded as GL rounds them, so
+// frames match the GL backend's on Mesa's llvmpipe pixel for pixel. The
+// background layer is kept as a finished image and drawn with one copy.
+class SoftwareRenderer : public RenderBackend
+{
+public:
+    SoftwareRenderer();
+
+    bool BeginFrame(int width, int height, float r, float g, float b) override;
+    void Flush() override;
+    void EndFrame() override;
+    void StoreBackground() override;
+    void DrawBackground() override;
+
+    // The last frame, Width() * Height() pixels with the bottom row first
+    // like glReadPixels, each R, G, B, A bytes in memory order.
+    const uint32_t *Pixels() const { return pixels.data(); }
+    int Width() const { return width; }
+    int Height() const { return height; }
+
+private:
+    void Clear();
+    void Fill(std::vector<uint32_t> &target, const CellInstance &cell);
+
+    int width, height;
+    uint32_t clearColor;
+    bool clearPending; // BeginFrame's clear, not yet written to pixels
+    std::vector<uint32_t> pixels;
+    std::vector<uint32_t> background; // the layer over backgroundClear, empty until StoreBackground
+    uint32_t backgroundClear;
+    std::vector<CellInstance> backgroundCells; // the same layer, for drawing over a started frame
+};
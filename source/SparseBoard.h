@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+// Occupancy bitmap for very large boards. The board is split into 64x64
+// chunks of one bit per cell, and only chunks with at least one occupied
+// cell are allocated, so memory follows the snake rather than the board
+// area. A chunk is released again when its last cell is cleared.
+class SparseBoard
+{
+public:
+    static const int CHUNK_SHIFT = 6;
+    static const int CHUNK_SIZE = 1 << CHUNK_SHIFT;
+
+    SparseBoard() : lastKey(0), lastChunk(nullptr) {}
+
+    bool Test(int x, int y) const
+    {
+        const Chunk *chunk = Find(Key(x, y));
+        return chunk && (chunk->rows[y & (CHUNK_SIZE - 1)] >> (x & (CHUNK_SIZE - 1)) & 1);
+    }
+
+    void Set(int x, int y)
+    {
+        uint64_t key = Key(x, y);
+        Chunk *chunk = const_cast<Chunk *>(Find(key));
+        if (!chunk)
+        {
+            chunk = &chunks[key];
+            lastKey = key;
+            lastChunk = chunk;
+        }
+
+        uint64_t bit = uint64_t(1) << (x & (CHUNK_SIZE - 1));
+        uint64_t &row = chunk->rows[y & (CHUNK_SIZE - 1)];
+        if (!(row & bit))
+        {
+            row |= bit;
+            chunk->population++;
+        }
+    }
+
+    void Clear(int x, int y)
+    {
+        uint64_t key = Key(x, y);
+        Chunk *chunk = const_cast<Chunk *>(Find(key));
+        if (!chunk)
+        {
+            return;
+        }
+
+        uint64_t bit = uint64_t(1) << (x & (CHUNK_SIZE - 1));
+        uint64_t &row = chunk->rows[y & (CHUNK_SIZE - 1)];
+        if (row & bit)
+        {
+            row &= ~bit;
+            if (--chunk->population == 0)
+            {
+                chunks.erase(key);
+                lastChunk = nullptr;
+            }
+        }
+    }
+
+    void Reset()
+    {
+        chunks.clear();
+        lastChunk = nullptr;
+    }
+
+    size_t ChunkCount() const { return chunks.size(); }
+
+    // Approximate heap use: chunk payloads, hash nodes and the bucket array.
+    size_t MemoryBytes() const
+    {
+        return chunks.size() * (sizeof(Chunk) + sizeof(uint64_t) + 2 * sizeof(void *)) +
+               chunks.bucket_count() * sizeof(void *);
+    }
+
+private:
+    struct Chunk
+    {
+        uint64_t rows[CHUNK_SIZE] = {};
+        int population = 0;
+    };
+
+    static uint64_t Key(int x, int y)
+    {
+        return (uint64_t(uint32_t(y >> CHUNK_SHIFT)) << 32) | uint32_t(x >> CHUNK_SHIFT);
+    }
+
+    // The snake head almost always stays in the chunk it was just in, so
+    // remember the last chunk touched and skip the hash lookup for it.
+    const Chunk *Find(uint64_t key) const
+    {
+        if (lastChunk && lastKey == key)
+        {
+            return lastChunk;
+        }
+        auto it = chunks.find(key);
+        if (it == chunks.end())
+        {
+            return nullptr;
+        }
+        lastKey = key;
+        lastChunk = const_cast<Chunk *>(&it->second);
+        return lastChunk;
+    }
+
+    std::unordered_map<uint64_t, Chunk> chunks;
+    mutable uint64_t lastKey;
+    mutable Chunk *lastChunk;
+};
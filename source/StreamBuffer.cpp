@@ -0,0 +1,137 @@
+#include "StreamBuffer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+StreamBuffer::StreamBuffer()
+    : frames(0), bytesUploaded(0), stallSeconds(0.0), buffer(0), persistent(false),
+      mapped(nullptr), regionBytes(0), region(0), cursor(0), fences()
+{
+}
+
+void StreamBuffer::Init(size_t frameBytes, bool allowPersistent)
+{
+    persistent = allowPersistent && glBufferStorage != nullptr;
+    Allocate(frameBytes);
+}
+
+void StreamBuffer::Shutdown()
+{
+    Release();
+}
+
+void StreamBuffer::Allocate(size_t frameBytes)
+{
+    regionBytes = frameBytes;
+    region = 0;
+    cursor = 0;
+
+    glGenBuffers(1, &buffer);
+    glState.BindArrayBuffer(buffer);
+    if (persistent)
+    {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_ARRAY_BUFFER, regionBytes * FRAMES_IN_FLIGHT, nullptr, flags);
+        mapped = (char *)glMapBufferRange(GL_ARRAY_BUFFER, 0, regionBytes * FRAMES_IN_FLIGHT, flags);
+        if (!mapped)
+        {
+            // immutable storage cannot be respecified, start over unmapped
+            persistent = false;
+            glState.DeleteBuffer(buffer);
+            glGenBuffers(1, &buffer);
+            glState.BindArrayBuffer(buffer);
+        }
+    }
+    if (!persistent)
+    {
+        glBufferData(GL_ARRAY_BUFFER, regionBytes, nullptr, GL_STREAM_DRAW);
+    }
+}
+
+void StreamBuffer::Release()
+{
+    for (GLsync &fence : fences)
+    {
+        if (fence)
+        {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+    if (mapped)
+    {
+        glState.BindArrayBuffer(buffer);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+        mapped = nullptr;
+    }
+    // the driver keeps the storage alive until draws already issued are done
+    glState.DeleteBuffer(buffer);
+    buffer = 0;
+}
+
+size_t StreamBuffer::Upload(const void *data, size_t bytes)
+{
+    if (cursor + bytes > regionBytes)
+    {
+        Release();
+        Allocate(std::max(regionBytes * 2, cursor + bytes));
+    }
+
+    size_t offset;
+    if (persistent)
+    {
+        if (cursor == 0)
+        {
+            WaitForRegion();
+        }
+        offset = size_t(region) * regionBytes + cursor;
+        std::memcpy(mapped + offset, data, bytes);
+    }
+    else
+    {
+        glState.BindArrayBuffer(buffer);
+        if (cursor == 0)
+        {
+            glBufferData(GL_ARRAY_BUFFER, regionBytes, nullptr, GL_STREAM_DRAW); // orphan
+        }
+        offset = cursor;
+        glBufferSubData(GL_ARRAY_BUFFER, offset, bytes, data);
+    }
+
+    cursor += bytes;
+    bytesUploaded += bytes;
+    return offset;
+}
+
+void StreamBuffer::EndFrame()
+{
+    if (persistent && cursor > 0)
+    {
+        fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        region = (region + 1) % FRAMES_IN_FLIGHT;
+    }
+    cursor = 0;
+    frames++;
+}
+
+void StreamBuffer::WaitForRegion()
+{
+    GLsync &fence = fences[region];
+    if (!fence)
+    {
+        return;
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    GLenum result = glClientWaitSync(fence, 0, 0);
+    while (result == GL_TIMEOUT_EXPIRED)
+    {
+        // the GPU is FRAMES_IN_FLIGHT frames behind, block until it catches up
+        result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+    }
+    stallSeconds += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+    glDeleteSync(fence);
+    fence = nullptr;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+
+#include "GLStateCache.h"
+
+// Ring buffer for data rewritten every frame, such as instance arrays. The
+// buffer is split into FRAMES_IN_FLIGHT regions and each frame writes only
+// its own region, so the CPU never touches memory the GPU may still be
+// reading and no upload forces an implicit sync.
+//
+// Where buffer storage is available the whole ring is mapped once,
+// persistently and coherently. Uploads are plain memcpys, and a fence per
+// region makes the CPU wait only if it laps the GPU. Elsewhere each frame
+// orphans the buffer with glBufferData and writes it with glBufferSubData,
+// leaving the driver to rename the storage.
+class StreamBuffer
+{
+public:
+    static const int FRAMES_IN_FLIGHT = 3;
+
+    StreamBuffer();
+
+    // Needs a current context. Regions start at frameBytes and grow when
+    // a frame uploads more.
+    void Init(size_t frameBytes, bool allowPersistent = true);
+    void Shutdown();
+
+    // Copies data into this frame's region and returns its byte offset in
+    // Buffer(). The buffer may be replaced when a frame outgrows its
+    // region, so bind Buffer() after the last Upload before drawing.
+    size_t Upload(const void *data, size_t bytes);
+    // Fences this frame's region and moves on to the next. Call once the
+    // draws reading it are issued.
+    void EndFrame();
+
+    GLuint Buffer() const { return buffer; }
+    bool IsPersistent() const { return mapped != nullptr; }
+
+    unsigned long long frames;        // EndFrame calls
+    unsigned long long bytesUploaded; // over the whole run
+    double stallSeconds;              // waiting for the GPU to free a region
+
+private:
+    void Allocate(size_t frameBytes);
+    void Release();
+    void WaitForRegion();
+
+    GLuint buffer;
+    bool persistent;
+    char *mapped;       // persistent mapping of the whole ring, or null
+    size_t regionBytes; // size of one frame's region
+    int region;         // region written this frame
+    size_t cursor;      // bytes used in it so far
+    GLsync fences[FRAMES_IN_FLIGHT];
+};
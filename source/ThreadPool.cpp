@@ -0,0 +1,137 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(int threadCount)
+    : generation(0), stopping(false), remaining(0), steals(0)
+{
+    if (threadCount <= 0)
+    {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (int i = 0; i < threadCount; i++)
+    {
+        queues.push_back(std::unique_ptr<Queue>(new Queue()));
+    }
+    for (int i = 1; i < threadCount; i++)
+    {
+        threads.emplace_back(&ThreadPool::WorkerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+}
+
+void ThreadPool::ParallelFor(size_t count, size_t grain,
+                             const std::function<void(size_t, size_t, int)> &fn)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    grain = std::max<size_t>(grain, 1);
+
+    // Deal the chunks out round-robin, each worker starts with its own
+    // share. A worker still looping from the last call may pick one up
+    // straight away, so the count must be in place first.
+    size_t chunks = (count + grain - 1) / grain;
+    remaining = chunks;
+    for (size_t i = 0; i < chunks; i++)
+    {
+        Queue &queue = *queues[i % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.ranges.push_back({i * grain, std::min(count, (i + 1) * grain), &fn});
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        generation++;
+    }
+    wake.notify_all();
+
+    RunChunks(0);
+
+    // other workers may still be finishing their last chunks
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [this]
+                  { return remaining == 0; });
+}
+
+void ThreadPool::WorkerLoop(int worker)
+{
+    unsigned long long seen = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&]
+                      { return stopping || generation != seen; });
+            if (stopping)
+            {
+                return;
+            }
+            seen = generation;
+        }
+
+        RunChunks(worker);
+    }
+}
+
+// All chunks are queued before the workers are woken, so once both the
+// local deque and every steal attempt come up empty there is nothing left
+// to take for this call.
+void ThreadPool::RunChunks(int worker)
+{
+    Range range;
+    while (PopLocal(worker, range) || Steal(worker, range))
+    {
+        (*range.fn)(range.begin, range.end, worker);
+        if (--remaining == 0)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            finished.notify_all();
+        }
+    }
+}
+
+bool ThreadPool::PopLocal(int worker, Range &range)
+{
+    Queue &queue = *queues[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.ranges.empty())
+    {
+        return false;
+    }
+    range = queue.ranges.back();
+    queue.ranges.pop_back();
+    return true;
+}
+
+bool ThreadPool::Steal(int worker, Range &range)
+{
+    int count = ThreadCount();
+    for (int i = 1; i < count; i++)
+    {
+        Queue &queue = *queues[(worker + i) % count];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.ranges.empty())
+        {
+            range = queue.ranges.front();
+            queue.ranges.pop_front();
+            steals++;
+            return true;
+        }
+    }
+    return false;
+}
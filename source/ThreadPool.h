@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing pool for sharding independent games across cores.
+// ParallelFor splits a range into chunks, deals them round-robin onto one
+// deque per worker, and each worker drains its own deque from the back
+// while idle workers steal from the front of the others. Deques are only
+// touched once per chunk, so the per-game hot path shares nothing; the
+// calling thread takes part as worker 0.
+class ThreadPool
+{
+public:
+    // threadCount 0 uses every hardware thread.
+    explicit ThreadPool(int threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    int ThreadCount() const { return static_cast<int>(queues.size()); }
+
+    // Calls fn(begin, end, worker) for chunks of at most `grain` items
+    // covering [0, count), and returns once all of them have run. `worker`
+    // is in [0, ThreadCount()) and stable for the thread running the chunk,
+    // so per-worker state (RNG streams, counters) can be indexed by it.
+    void ParallelFor(size_t count, size_t grain,
+                     const std::function<void(size_t, size_t, int)> &fn);
+
+    // Chunks taken from another worker's deque, summed over all runs.
+    unsigned long long StealCount() const { return steals.load(); }
+
+private:
+    // Chunks carry their job, so a worker that wakes late can never pair
+    // a chunk with the wrong call.
+    struct Range
+    {
+        size_t begin, end;
+        const std::function<void(size_t, size_t, int)> *fn;
+    };
+
+    struct alignas(64) Queue
+    {
+        std::mutex mutex;
+        std::deque<Range> ranges;
+    };
+
+    void WorkerLoop(int worker);
+    void RunChunks(int worker);
+    bool PopLocal(int worker, Range &range);
+    bool Steal(int worker, Range &range);
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> threads;
+
+    std::mutex mutex; // guards generation and stopping
+    std::condition_variable wake;
+    std::condition_variable finished;
+    unsigned long long generation;
+    bool stopping;
+
+    std::atomic<size_t> remaining; // chunks of the current job not yet run
+    std::atomic<unsigned long long> steals;
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+
+// Hands the latest value from one writer thread to one reader thread
+// without locks. Each side owns one of three slots and the third sits in
+// the middle; Publish and Acquire swap a slot with the middle one in a
+// single atomic exchange, so neither side ever waits for the other or sees
+// a half-written value. The reader skips values published while it was
+// busy and only ever gets the newest one.
+template <typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() : back(0), middle(1), front(2) {}
+
+    // Writer: fill this slot, then Publish it.
+    T &WriteBuffer() { return slots[back]; }
+    void Publish()
+    {
+        back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX;
+    }
+
+    // Reader: takes the newest published value, if there is one since the
+    // last call, and returns whether it did.
+    bool Acquire()
+    {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH))
+        {
+            return false;
+        }
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+    const T &ReadBuffer() const { return slots[front]; }
+
+private:
+    static const int INDEX = 3; // low bits of middle: the slot
+    static const int FRESH = 4; // set by Publish, cleared by Acquire
+
+    T slots[3];
+    int back; // writer only
+    std::atomic<int> middle;
+    int front; // reader only
+};
@@ -0,0 +1,141 @@
+// Runs the snake simulation without a window or GL context, for batch and
+// server-side workloads, and reports how many ticks per second it sustains.
+//
+// Input is either random (a turn on roughly one tick in four) or a script
+// file of U/D/L/R characters, one per tick, where '.' keeps the current
+// direction; the script repeats until the tick budget is used. Games that
+// end are restarted straight away. With --seed the whole run, fruit and
+// random input alike, is reproducible on any platform.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <cstdint>
+#include <random>
+#include <string>
+
+#include "Game.h"
+
+static Direction ScriptDirection(char c)
+{
+    switch (c)
+    {
+    case 'U':
+        return Direction::Up;
+    case 'D':
+        return Direction::Down;
+    case 'L':
+        return Direction::Left;
+    case 'R':
+        return Direction::Right;
+    default:
+        return Direction::None;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int width = DEFAULT_GRID_SIZE;
+    int height = DEFAULT_GRID_SIZE;
+    unsigned long long ticks = 10000000;
+    uint64_t seed = std::random_device()();
+    std::string script;
+    const char *usage = " [--grid WIDTHxHEIGHT] [--ticks N] [--seed N] [--script FILE]\n";
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--grid" && i + 1 < argc)
+        {
+            if (std::sscanf(argv[++i], "%dx%d", &width, &height) != 2)
+            {
+                std::cerr << "Invalid grid size, expected WIDTHxHEIGHT\n";
+                return -1;
+            }
+        }
+        else if (arg == "--ticks" && i + 1 < argc)
+        {
+            ticks = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--seed" && i + 1 < argc)
+        {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--script" && i + 1 < argc)
+        {
+            std::ifstream file(argv[++i]);
+            if (!file)
+            {
+                std::cerr << "Cannot open script " << argv[i] << "\n";
+                return -1;
+            }
+            char c;
+            while (file >> c)
+            {
+                script += c;
+            }
+        }
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << usage;
+            return -1;
+        }
+    }
+
+    if (width < Board::MIN_SIZE || width > Board::MAX_SIZE ||
+        height < Board::MIN_SIZE || height > Board::MAX_SIZE)
+    {
+        std::cerr << "Grid size must be between " << Board::MIN_SIZE << " and "
+                  << Board::MAX_SIZE << " cells per side\n";
+        return -1;
+    }
+
+    GameState game;
+    game.SetGridSize(width, height);
+    game.Seed(seed);
+    game.Start();
+
+    Random input(seed, 1); // separate stream from the fruit
+    unsigned long long games = 1;
+    unsigned long long totalScore = 0;
+    int bestScore = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned long long tick = 0; tick < ticks; tick++)
+    {
+        if (!script.empty())
+        {
+            game.Steer(ScriptDirection(script[tick % script.size()]));
+        }
+        else if (input.Below(4) == 0)
+        {
+            game.Steer(static_cast<Direction>(input.Below(4)));
+        }
+
+        game.Step();
+
+        if (game.gameOver)
+        {
+            totalScore += game.score;
+            if (game.score > bestScore)
+            {
+                bestScore = game.score;
+            }
+            games++;
+            game.Restart();
+            game.Start();
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+
+    std::printf("board %dx%d, seed %llu, %s input\n", width, height, (unsigned long long)seed,
+                script.empty() ? "random" : "scripted");
+    std::printf("ticks: %llu in %.3f s (%.0f ticks/s)\n", ticks, seconds, ticks / seconds);
+    std::printf("games: %llu finished, mean score %.1f, best %d\n", games - 1,
+                games > 1 ? double(totalScore) / (games - 1) : 0.0, bestScore);
+    std::printf("final state: score %d, length %zu, fruit %d,%d\n", game.score,
+                game.snake.size(), game.fruit.x, game.fruit.y);
+    return 0;
+}
@@ -1,157 +1,71 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <iostream>
-#include <vector>
-#include <random>
 #include <chrono>
-#include <cmath>
-#include <map>
 #include <string>
-
-struct vec2
-{
-    float x, y;
-    vec2() : x(0.0f), y(0.0f) {}
-    vec2(float x, float y) : x(x), y(y) {}
-};
-
-struct vec2i
-{
-    int x, y;
-    vec2i() : x(0), y(0) {}
-    vec2i(int x, int y) : x(x), y(y) {}
-
-    bool operator==(const vec2i &other) const
-    {
-        return x == other.x && y == other.y;
-    }
-};
-struct vec3
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <ctime>
+#include <atomic>
+#include <thread>
+
+#include "FramePacer.h"
+#include "Game.h"
+#include "GameRenderer.h"
+#include "TripleBuffer.h"
+
+const double IDLE_TIMEOUT = 0.5; // longest input wait while nothing animates
+const std::chrono::milliseconds RENDER_IDLE_SLEEP(5); // render thread, nothing new to draw
+
+enum class Pacing
 {
-    float r, g, b;
-    vec3() : r(0.0f), g(0.0f), b(0.0f) {}
-    vec3(float r, float g, float b) : r(r), g(g), b(b) {}
+    VSync, // swap interval 1, the driver blocks in glfwSwapBuffers
+    Limit, // FramePacer at --fps, no vsync
+    None   // as fast as possible
 };
 
-const int GRID_WIDTH = 20;
-const int GRID_HIGHT = 20;
-const float UPDATE_INTERVAL = 0.15f;
-const float CELL_WIDTH = 2.0f / GRID_WIDTH;
-const float CELL_HEIGHT = 2.0f / GRID_HIGHT;
-
-enum class Direction
+// What the main thread hands to the renderer: the game plus the window
+// state the GL side needs, stamped with when it was taken.
+struct Frame
 {
-    Up,
-    Down,
-    Left,
-    Right,
-    None
+    GameSnapshot game;
+    double time = 0.0; // Now() when taken
+    int framebufferWidth = 0, framebufferHeight = 0;
+    bool visible = false;   // not iconified
+    bool animating = false; // changes on screen between snapshots
+    bool overlay = false;   // performance overlay, toggled with F3
+    HostStats host;
 };
 
-Direction snakeDirection = Direction::None;
-std::vector<vec2i> snake = {vec2i(5, 10), vec2i(4, 10), vec2i(3, 10)};
-vec2i fruit;
-int score = 0;
-bool gameOver = false;
-bool gameStarted = false;
-float timeSinceLastUpdate = 0.0f;
-float snakeSpeed = UPDATE_INTERVAL;
-float gameOverTime = 0.0f;
-
-const char *vertexShaderSource = R"(
-#version 330 core
-layout (location = 0) in vec2 aPos;
-
-uniform vec2 uOffSet;
-uniform vec2 uScale;
-
-void main()
-{
-    vec2 position = (aPos * uScale) + uOffSet;
-    gl_Position = vec4(position, 0.0, 1.0);
-}
-
-)";
-
-const char *fragmentShaderSource = R"(
-#version 330 core
-out vec4 FragColor;
-uniform vec3 uColor;
+GameState game; // main thread only
+bool showOverlay = false;
+HostStats hostStats; // update cost and tick rate, measured on the main thread
+TripleBuffer<Frame> frames;
+std::atomic<bool> running(true);
+bool singleThread = false; // --single-thread keeps GL on the main thread
+
+Pacing pacing = Pacing::VSync;
+bool persistentMapping = true; // --no-persistent-map forces buffer orphaning
+bool boardTexture = false;     // --board-texture draws the board in one shader pass
+bool damageTracking = false;   // --damage redraws only what changed
+FramePacer pacer;
+
+bool ParseArgs(int argc, char **argv);
+double IdleTimeout(GLFWwindow *window);
+double Now();
+void PublishFrame(GLFWwindow *window);
+void RenderLoop(GLFWwindow *window);
+void DrawFrame(GLFWwindow *window, const Frame &frame);
+void KeyCallBackfun(GLFWwindow *window, int key, int scanCode, int action, int mods);
 
-void main()
+int main(int argc, char **argv)
 {
-    FragColor = vec4(uColor, 1.0);
-}
+    if (!ParseArgs(argc, argv))
+    {
+        return -1;
+    }
 
-)";
-GLuint shaderProgram;
-GLuint VAO, VBO;
-GLint uOffSetLocation, uScaleLocation, uColorLocation;
-
-const int FONT_WITH = 5;
-const int FONT_HEIGHT = 5;
-const int FONT_SPACING = 1;
-
-std::map<char, std::vector<int>> fontMap = {
-    {' ', {0,0,0,0,0, 0,0,0,0,0, 0,0,0,0,0, 0,0,0,0,0, 0,0,0,0,0}},
-    {'A', {0,1,1,0,0, 1,0,0,1,0, 1,1,1,1,0, 1,0,0,1,0, 1,0,0,1,0}},
-    {'B', {1,1,1,0,0, 1,0,0,1,0, 1,1,1,0,0, 1,0,0,1,0, 1,1,1,0,0}},
-    {'C', {0,1,1,1,0, 1,0,0,0,0, 1,0,0,0,0, 1,0,0,0,0, 0,1,1,1,0}},
-    {'D', {1,1,1,0,0, 1,0,0,1,0, 1,0,0,1,0, 1,0,0,1,0, 1,1,1,0,0}},
-    {'E', {1,1,1,1,0, 1,0,0,0,0, 1,1,1,0,0, 1,0,0,0,0, 1,1,1,1,0}},
-    {'F', {1,1,1,1,0, 1,0,0,0,0, 1,1,1,0,0, 1,0,0,0,0, 1,0,0,0,0}},
-    {'G', {0,1,1,1,0, 1,0,0,0,0, 1,0,1,1,0, 1,0,0,1,0, 0,1,1,1,0}},
-    {'H', {1,0,0,1,0, 1,0,0,1,0, 1,1,1,1,0, 1,0,0,1,0, 1,0,0,1,0}},
-    {'I', {1,1,1,0,0, 0,1,0,0,0, 0,1,0,0,0, 0,1,0,0,0, 1,1,1,0,0}},
-    {'J', {0,0,1,1,0, 0,0,0,1,0, 0,0,0,1,0, 1,0,0,1,0, 0,1,1,0,0}},
-    {'K', {1,0,0,1,0, 1,0,1,0,0, 1,1,0,0,0, 1,0,1,0,0, 1,0,0,1,0}},
-    {'L', {1,0,0,0,0, 1,0,0,0,0, 1,0,0,0,0, 1,0,0,0,0, 1,1,1,1,0}},
-    {'M', {1,0,0,0,1, 1,1,0,1,1, 1,0,1,0,1, 1,0,0,0,1, 1,0,0,0,1}},
-    {'N', {1,0,0,0,1, 1,1,0,0,1, 1,0,1,0,1, 1,0,0,1,1, 1,0,0,0,1}},
-    {'O', {0,1,1,0,0, 1,0,0,1,0, 1,0,0,1,0, 1,0,0,1,0, 0,1,1,0,0}},
-    {'P', {1,1,1,0,0, 1,0,0,1,0, 1,1,1,0,0, 1,0,0,0,0, 1,0,0,0,0}},
-    {'Q', {0,1,1,0,0, 1,0,0,1,0, 1,0,0,1,0, 1,0,1,0,0, 0,1,0,1,0}},
-    {'R', {1,1,1,0,0, 1,0,0,1,0, 1,1,1,0,0, 1,0,1,0,0, 1,0,0,1,0}},
-    {'S', {0,1,1,1,0, 1,0,0,0,0, 0,1,1,0,0, 0,0,0,1,0, 1,1,1,0,0}},
-    {'T', {1,1,1,1,1, 0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0}},
-    {'U', {1,0,0,1,0, 1,0,0,1,0, 1,0,0,1,0, 1,0,0,1,0, 0,1,1,0,0}},
-    {'V', {1,0,0,0,1, 1,0,0,0,1, 0,1,0,1,0, 0,1,0,1,0, 0,0,1,0,0}},
-    {'W', {1,0,0,0,1, 1,0,0,0,1, 1,0,1,0,1, 1,0,1,0,1, 0,1,0,1,0}},
-    {'X', {1,0,0,0,1, 0,1,0,1,0, 0,0,1,0,0, 0,1,0,1,0, 1,0,0,0,1}},
-    {'Y', {1,0,0,0,1, 0,1,0,1,0, 0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0}},
-    {'Z', {1,1,1,1,1, 0,0,0,1,0, 0,0,1,0,0, 0,1,0,0,0, 1,1,1,1,1}},
-    {'0', {0,1,1,0,0, 1,0,0,1,0, 1,0,0,1,0, 1,0,0,1,0, 0,1,1,0,0}},
-    {'1', {0,0,1,0,0, 0,1,1,0,0, 0,0,1,0,0, 0,0,1,0,0, 0,1,1,1,0}},
-    {'2', {0,1,1,0,0, 1,0,0,1,0, 0,0,1,0,0, 0,1,0,0,0, 1,1,1,1,0}},
-    {'3', {1,1,1,0,0, 0,0,0,1,0, 0,1,1,0,0, 0,0,0,1,0, 1,1,1,0,0}},
-    {'4', {0,0,1,1,0, 0,1,0,1,0, 1,0,0,1,0, 1,1,1,1,1, 0,0,0,1,0}},
-    {'5', {1,1,1,1,0, 1,0,0,0,0, 1,1,1,0,0, 0,0,0,1,0, 1,1,1,0,0}},
-    {'6', {0,1,1,0,0, 1,0,0,0,0, 1,1,1,0,0, 1,0,0,1,0, 0,1,1,0,0}},
-    {'7', {1,1,1,1,0, 0,0,0,1,0, 0,0,1,0,0, 0,1,0,0,0, 1,0,0,0,0}},
-    {'8', {0,1,1,0,0, 1,0,0,1,0, 0,1,1,0,0, 1,0,0,1,0, 0,1,1,0,0}},
-    {'9', {0,1,1,0,0, 1,0,0,1,0, 0,1,1,1,0, 0,0,0,1,0, 0,1,1,0,0}},
-    {':', {0,0,0,0,0, 0,0,1,0,0, 0,0,0,0,0, 0,0,1,0,0, 0,0,0,0,0}},
-    {'-', {0,0,0,0,0, 0,0,0,0,0, 1,1,1,1,0, 0,0,0,0,0, 0,0,0,0,0}},
-    {'.', {0,0,0,0,0, 0,0,0,0,0, 0,0,0,0,0, 0,0,0,0,0, 0,0,1,0,0}}
-};
-void SpawnFruit();
-void InitGame();
-void ResetGame();
-void KeyCallBackfun(GLFWwindow *window, int key, int scanCode, int action, int mods);
-void DrawCell(const vec2i &position, const vec3 &color);
-void DrawChar(char c, float x, float y, float scale, const vec3 &color);
-void DrawText(const std::string &text, float x, float y, float scale, const vec3 &color);
-void RenderGame(GLFWwindow *window);
-void UpdateGame(float deltaTime);
-void DrawBorder();
-void DrawSnake();
-void DrawScore();
-void DrawGameOver();
-void DrawStartScreen();
-void DrawAnimatedGameOverBorder();
-
-int main()
-{
 #if defined(__APPLE__)
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
@@ -178,468 +92,328 @@ int main()
     }
 
     glfwMakeContextCurrent(window);
-
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
-    {
-        std::cerr << "Failed to initialize GLAD\n";
-        return -1;
-    }
-
-    int w, h;
-    glfwGetFramebufferSize(window, &w, &h);
-    glViewport(0, 0, w, h);
+    glfwSwapInterval(pacing == Pacing::VSync ? 1 : 0);
 
     glfwSetKeyCallback(window, KeyCallBackfun);
 
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    if (!InitGameRenderer((GLADloadproc)glfwGetProcAddress, persistentMapping, boardTexture,
+                          damageTracking))
     {
-        std::cerr << "Failed to initialize GLAD\n";
+        glfwTerminate();
         return -1;
     }
-    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexShaderSource, nullptr);
-    glCompileShader(vertexShader);
-
-    GLint success;
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (!success)
-    {
-        char infoLog[512];
-        glGetShaderInfoLog(vertexShader, 512, nullptr, infoLog);
-        std::cerr << "Vertex shader error:\n"<< infoLog << std::endl;
-    }
-
-    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, nullptr);
-    glCompileShader(fragmentShader);
-
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success)
-    {
-        char infoLog[512];
-        glGetShaderInfoLog(fragmentShader, 512, nullptr, infoLog);
-        std::cerr << "Fragment shader error:\n" << infoLog << std::endl;
-    }
-
-    shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
 
-    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-    if (!success)
+    // GL belongs to the render thread from here; events, input and the
+    // simulation stay on this one, as GLFW requires
+    std::thread renderThread;
+    if (!singleThread)
     {
-        char infoLog[512];
-        glGetProgramInfoLog(shaderProgram, 512, nullptr, infoLog);
-        std::cerr << "Shader link error:\n"<< infoLog << std::endl;
+        glfwMakeContextCurrent(nullptr);
+        renderThread = std::thread(RenderLoop, window);
     }
 
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-
-    uOffSetLocation = glGetUniformLocation(shaderProgram, "uOffSet");
-    uScaleLocation = glGetUniformLocation(shaderProgram, "uScale");
-    uColorLocation = glGetUniformLocation(shaderProgram, "uColor");
-
-    float vertices[] = {
-        -0.5f, -0.5f,
-        0.5f,  -0.5f,
-        -0.5f,  0.5f,
-        0.5f,   0.5f,
-    };
-
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void *)0);
-    glEnableVertexAttribArray(0);
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-
-    InitGame();
     auto lastTime = std::chrono::high_resolution_clock::now();
+    auto runStart = lastTime;
+    std::clock_t cpuStart = std::clock();
+    unsigned long long loopCount = 0;
+    float longestFrame = 0.0f;
+    auto rateStart = lastTime;
+    unsigned long long rateTicks = 0;
     while (!glfwWindowShouldClose(window))
     {
+        // block for input instead of redrawing a frame nobody would see change
+        double timeout = IdleTimeout(window);
+        if (timeout >= 0.0)
+        {
+            glfwWaitEventsTimeout(timeout);
+        }
+        else
+        {
+            glfwPollEvents();
+        }
+
         auto currentTime = std::chrono::high_resolution_clock::now();
         float deltaTime = std::chrono::duration<float>(currentTime - lastTime).count();
         lastTime = currentTime;
+        longestFrame = std::max(longestFrame, deltaTime);
+        loopCount++;
 
-        glfwPollEvents();
-        UpdateGame(deltaTime);
-        RenderGame(window);
-    }
-
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-    glDeleteProgram(shaderProgram);
-
-    glfwTerminate();
-    return 0;
-}
+        game.Update(deltaTime);
+        auto updateEnd = std::chrono::high_resolution_clock::now();
+        hostStats.updateMs = std::chrono::duration<float, std::milli>(updateEnd - currentTime).count();
 
-void UpdateGame(float deltaTime)
-{
-    if (gameOver)
-    {
-        gameOverTime += deltaTime;
-        return;
-    }
-    if (gameStarted && !gameOver)
-    {
-        timeSinceLastUpdate += deltaTime;
-        if (timeSinceLastUpdate >= snakeSpeed)
+        // tick rate over half-second windows
+        double rateSeconds = std::chrono::duration<double>(updateEnd - rateStart).count();
+        if (rateSeconds >= 0.5)
         {
-            timeSinceLastUpdate = 0.0f;
-            vec2i newHead = snake[0];
+            hostStats.tickRate = float((game.tickStats.ticks - rateTicks) / rateSeconds);
+            rateTicks = game.tickStats.ticks;
+            rateStart = updateEnd;
+        }
 
-            switch (snakeDirection)
-            {
-            case Direction::Up:
-                newHead.y++;
-                break;
-            case Direction::Down:
-                newHead.y--;
-                break;
-            case Direction::Left:
-                newHead.x--;
-                break;
-            case Direction::Right:
-                newHead.x++;
-                break;
-
-            case Direction::None:
-                return;
-            }
-            if (newHead.x < 0 || newHead.x >= GRID_WIDTH ||
-                newHead.y < 0 || newHead.y >= GRID_HIGHT)
-            {
+        PublishFrame(window);
 
-                gameOver = true;
-                return;
-            }
-            for (const auto &segment : snake)
-            {
-                if (newHead == segment)
-                {
-                    gameOver = true;
-                    return;
-                }
-            }
-            snake.insert(snake.begin(), newHead);
-            if (newHead == fruit)
+        if (singleThread)
+        {
+            frames.Acquire();
+            if (frames.ReadBuffer().visible)
             {
-                score += 10;
-                SpawnFruit();
-
-                if (score % 50 == 0 && snakeSpeed > 0.05f)
-                {
-                    snakeSpeed -= 0.01f;
-                }
+                DrawFrame(window, frames.ReadBuffer());
             }
-            else
+            if (pacing == Pacing::Limit && timeout < 0.0)
             {
-                snake.pop_back();
+                pacer.Wait();
             }
         }
     }
-}
-
-void RenderGame(GLFWwindow *window)
-{
-    glClearColor(0.08f, 0.1f, 0.12f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT);
 
-    glUseProgram(shaderProgram);
-    glBindVertexArray(VAO);
-
-    DrawBorder();
-
-    if (!gameStarted)
+    running = false;
+    if (renderThread.joinable())
     {
-        DrawStartScreen();
+        renderThread.join();
+        glfwMakeContextCurrent(window);
     }
-    else if (gameOver)
-    {
 
-        DrawGameOver();
-    }
-    else
-    {
-        DrawSnake();
-        DrawScore();
-    }
+    double runSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - runStart).count();
+    double cpuSeconds = double(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+    const char *pacingNames[] = {"vsync", "limit", "none"};
+    std::cout << "pacing: " << pacingNames[int(pacing)]
+              << ", loop iterations: " << loopCount
+              << ", mean frame time: " << runSeconds / std::max(1ull, loopCount) * 1000.0 << "ms"
+              << ", longest: " << longestFrame * 1000.0f << "ms"
+              << ", CPU: " << cpuSeconds / runSeconds * 100.0 << "%\n";
+
+    const TickStats &stats = game.tickStats;
+    std::cout << "ticks: " << stats.ticks
+              << ", capped frames: " << stats.cappedFrames
+              << ", dropped: " << stats.droppedTime << "s"
+              << ", sim lag: " << (stats.realTime - stats.simTime) << "s"
+              << ", tick lateness: mean " << stats.lateTime / std::max(1ull, stats.ticks) * 1000.0
+              << "ms, max " << stats.maxLate * 1000.0 << "ms"
+              << " (" << (singleThread ? "single thread" : "render thread") << ")\n";
+    PrintRenderStats(std::cout);
+
+    ShutdownGameRenderer();
 
-    glBindVertexArray(0);
-    glfwSwapBuffers(window);
+    glfwTerminate();
+    return 0;
 }
 
-void DrawCell(const vec2i &position, const vec3 &color)
+// Takes the drawable state and window state, for whichever thread renders.
+void PublishFrame(GLFWwindow *window)
 {
-    vec2 offsSet(-1.0f + position.x * CELL_WIDTH + CELL_WIDTH * 0.5f,
-                 -1.0f + position.y * CELL_HEIGHT + CELL_HEIGHT * 0.5f);
-    vec2 scale(CELL_WIDTH * 0.9f, CELL_HEIGHT * 0.9f);
-
-    glUniform3f(uColorLocation, color.r, color.g, color.b);
-    glUniform2f(uOffSetLocation, offsSet.x, offsSet.y);
-    glUniform2f(uScaleLocation, scale.x, scale.y);
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    Frame &frame = frames.WriteBuffer();
+    game.TakeSnapshot(frame.game);
+    frame.time = Now();
+    glfwGetFramebufferSize(window, &frame.framebufferWidth, &frame.framebufferHeight);
+    frame.visible = !glfwGetWindowAttrib(window, GLFW_ICONIFIED);
+    frame.animating = (game.gameStarted && glfwGetWindowAttrib(window, GLFW_FOCUSED)) || showOverlay;
+    frame.overlay = showOverlay;
+    frame.host = hostStats;
+    frames.Publish();
 }
-void DrawChar(char c, float x, float y, float scale, const vec3 &color)
-{
-    c = std::toupper((c));
-    auto it = fontMap.find(c);
-    if (it == fontMap.end())
-    {
-        it = fontMap.find(' ');
-    }
 
-    const std::vector<int> &bitmap = it->second;
-    float charWidth = FONT_WITH * scale;
-    float charHeight = FONT_HEIGHT * scale;
-
-    for (int i = 0; i < FONT_HEIGHT; i++)
+// Draws the newest published frame, and keeps redrawing it while it
+// animates. Between snapshots the snake and the game-over pulse are carried
+// forward from the frame's timestamp, so the main thread only has to
+// publish when a tick or input changes something.
+void RenderLoop(GLFWwindow *window)
+{
+    glfwMakeContextCurrent(window);
+    while (running.load(std::memory_order_relaxed))
     {
-        for (int j = 0; j < FONT_WITH; j++)
+        bool fresh = frames.Acquire();
+        const Frame &frame = frames.ReadBuffer();
+        if (!frame.visible || (!fresh && !frame.animating))
         {
-            if (bitmap[i * FONT_WITH + j])
-            {
-                vec2 offset(x + j * scale - charWidth / 2.0f,
-                            y - i * scale + charHeight / 2.0f);
+            std::this_thread::sleep_for(RENDER_IDLE_SLEEP);
+            continue;
+        }
 
-                glUniform3f(uColorLocation, color.r, color.g, color.b);
-                glUniform2f(uOffSetLocation, offset.x, offset.y);
-                glUniform2f(uScaleLocation, scale, scale);
-                glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-            }
+        DrawFrame(window, frame);
+        if (pacing == Pacing::Limit)
+        {
+            pacer.Wait();
         }
     }
+    glfwMakeContextCurrent(nullptr);
 }
 
-void DrawText(const std::string &text, float x, float y, float scale, const vec3 &color)
+bool ParseArgs(int argc, char **argv)
 {
-    float charWith = FONT_WITH * scale;
-    float spacing = FONT_SPACING * scale;
-    float tolalWidth = text.size() * (charWith + spacing) - spacing;
+    int width = DEFAULT_GRID_SIZE;
+    int height = DEFAULT_GRID_SIZE;
+    const char *usage = " [--grid WIDTHxHEIGHT] [--max-ticks-per-frame N]"
+                        " [--pacing vsync|limit|none] [--fps N] [--no-persistent-map]"
+                        " [--single-thread] [--board-texture] [--damage]\n";
 
-    float startX = x - tolalWidth / 2.0f;
-    for (size_t i = 0; i < text.size(); i++)
+    for (int i = 1; i < argc; i++)
     {
-        DrawChar(text[i], startX + i * (charWith + spacing), y, scale, color);
+        std::string arg = argv[i];
+        if (arg == "--grid" && i + 1 < argc)
+        {
+            if (std::sscanf(argv[++i], "%dx%d", &width, &height) != 2)
+            {
+                std::cerr << "Invalid grid size, expected WIDTHxHEIGHT\n";
+                return false;
+            }
+        }
+        else if (arg == "--max-ticks-per-frame" && i + 1 < argc)
+        {
+            game.maxTicksPerFrame = std::atoi(argv[++i]);
+            if (game.maxTicksPerFrame < 1)
+            {
+                std::cerr << "--max-ticks-per-frame must be at least 1\n";
+                return false;
+            }
+        }
+        else if (arg == "--pacing" && i + 1 < argc)
+        {
+            std::string mode = argv[++i];
+            if (mode == "vsync")
+                pacing = Pacing::VSync;
+            else if (mode == "limit")
+                pacing = Pacing::Limit;
+            else if (mode == "none")
+                pacing = Pacing::None;
+            else
+            {
+                std::cerr << "--pacing must be vsync, limit or none\n";
+                return false;
+            }
+        }
+        else if (arg == "--fps" && i + 1 < argc)
+        {
+            double fps = std::atof(argv[++i]);
+            if (fps < 1.0)
+            {
+                std::cerr << "--fps must be at least 1\n";
+                return false;
+            }
+            pacer.SetTargetFps(fps);
+            pacing = Pacing::Limit;
+        }
+        else if (arg == "--no-persistent-map")
+        {
+            persistentMapping = false;
+        }
+        else if (arg == "--single-thread")
+        {
+            singleThread = true;
+        }
+        else if (arg == "--board-texture")
+        {
+            boardTexture = true;
+        }
+        else if (arg == "--damage")
+        {
+            damageTracking = true;
+        }
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << usage;
+            return false;
+        }
     }
-}
-
-void DrawBorder()
-{
-    vec3 borderColor(0.3f, 0.3f, 0.5f);
 
-    for (int x = -1; x <= GRID_WIDTH; x++) // top
+    if (width < Board::MIN_SIZE || width > Board::MAX_SIZE ||
+        height < Board::MIN_SIZE || height > Board::MAX_SIZE)
     {
-        DrawCell(vec2i(x, GRID_HIGHT), borderColor);
+        std::cerr << "Grid size must be between " << Board::MIN_SIZE << " and "
+                  << Board::MAX_SIZE << " cells per side\n";
+        return false;
     }
 
-    for (int x = -1; x <= GRID_WIDTH; x++) // bottom
-    {
-        DrawCell(vec2i(x, -1), borderColor);
-    }
+    game.SetGridSize(width, height);
+    return true;
+}
 
-    for (int y = -1; y <= GRID_HIGHT; y++) // Left
+// How long the main loop may block waiting for input, or a negative value
+// to keep drawing at the paced rate. Only the live game in a focused window
+// animates every frame; the start screen is static, and in the background
+// the snake only needs redrawing when it moves. With a render thread the
+// animation is drawn there, so this loop only wakes for input and ticks.
+double IdleTimeout(GLFWwindow *window)
+{
+    // the overlay graphs move every frame
+    if (showOverlay && singleThread && !glfwGetWindowAttrib(window, GLFW_ICONIFIED))
     {
-        DrawCell(vec2i(-1, y), borderColor);
+        return -1.0;
     }
-
-    for (int y = -1; y <= GRID_HIGHT; y++) // Right
+    if (!game.gameStarted)
     {
-        DrawCell(vec2i(GRID_WIDTH, y), borderColor);
+        return IDLE_TIMEOUT;
     }
 
-    vec3 gridColor(0.082f, 0.106f, 0.329f);
-
-    for (int x = 0; x < GRID_WIDTH; x++)
+    bool visible = !glfwGetWindowAttrib(window, GLFW_ICONIFIED);
+    bool focused = glfwGetWindowAttrib(window, GLFW_FOCUSED);
+    if (visible && focused && singleThread)
     {
-        for (int y = 0; y < GRID_HIGHT; y++)
-        {
-            if ((x + y) % 2 == 0)
-            {
-                DrawCell(vec2i(x, y), gridColor);
-            }
-        }
+        return -1.0;
     }
-}
-
-void DrawSnake()
-{
-    vec3 headColor(0.0f, 0.95f, 0.3f); // snake head color
-    vec3 bodyColor(0.0f, 0.7f, 0.1f);  // snake body color
-
-    for (size_t i = 1; i < snake.size(); i++)
+    if (game.gameOver)
     {
-        float factor = static_cast<float>(i) / snake.size();
-
-        vec3 segmentcolor(
-            bodyColor.r * (1.0f - factor) + 0.1f * factor,
-            bodyColor.g * (1.0f - factor) + 0.1f * factor,
-            bodyColor.b * (1.0f - factor));
-        DrawCell(snake[i], segmentcolor);
+        return IDLE_TIMEOUT; // just the pulsing border
     }
-    DrawCell(snake[0], headColor);           // draw snake
-    DrawCell(fruit, vec3(1.0f, 0.3f, 0.3f)); // fruit color
-}
-
-void DrawScore()
-{
-    std::string scoreText = "SCORE: " + std::to_string(score);
-    DrawText(scoreText, 0.0f, 0.9f, 0.012f, vec3(0.9f, 0.9f, 0.9f));
+    return std::max(0.0, game.snakeSpeed - game.tickAccumulator);
 }
 
-void DrawGameOver()
+void DrawFrame(GLFWwindow *window, const Frame &frame)
 {
-    for (int x = 0; x < GRID_WIDTH; x++)
-    {
-        for (int y = 0; y < GRID_HIGHT; y++)
-        {
-            DrawCell(vec2i(x, y), vec3(0.2f, 0.1f, 0.1f));
-        }
-    }
-    DrawAnimatedGameOverBorder();
-    DrawText("GAME OVER", 0.0f, 0.2f, 0.025f, vec3(0.9f, 0.2f, 0.2f));
-
-    std::string scoreText = "SCORE : " + std::to_string(score);
-    DrawText(scoreText, 0.0f, 0.0f, 0.018f, vec3(0.9f, 0.9f, 0.9f));
-
-    DrawText("PRESS R TO RESTART", 0.0f, -0.2f, 0.015f, vec3(0.8f, 0.8f, 0.8f));
+    SetPerfOverlay(frame.overlay, frame.host);
+    RenderGame(frame.game, static_cast<float>(Now() - frame.time), frame.framebufferWidth,
+               frame.framebufferHeight);
+    glfwSwapBuffers(window);
+    FramePresented();
 }
 
-void DrawStartScreen()
+double Now()
 {
-    DrawText("SNAKE GAME", 0.0f, 0.3f, 0.025f, vec3(0.2f, 0.8f, 0.3f)); // title
-
-    DrawText("USE ARROW KEY TO MOVE", 0.0f, 0.0f, 0.012f, vec3(0.9f, 0.9f, 0.9f));
-    DrawText("EAT THE RED FRUIT TO GROW", 0.0f, -0.1f, 0.012f, vec3(0.9f, 0.9f, 0.9f));
-    DrawText("AVOID WALLS AND YOURSELF", 0.0f, -0.2f, 0.012f, vec3(0.9f, 0.9f, 0.9f));
-    DrawText("PRESS ANY KEY TO START", 0.0f, -0.4f, 0.012f, vec3(0.8f, 0.8f, 0.2f));
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
 }
 
-void SpawnFruit()
+void KeyCallBackfun(GLFWwindow *window, int key, int scanCode, int action, int mods)
 {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-
-    std::uniform_int_distribution<> distX(0, GRID_WIDTH - 1);
-    std::uniform_int_distribution<> distY(0, GRID_HIGHT - 1);
-
-    while (true)
+    if (key == GLFW_KEY_F3)
     {
-        vec2i newFruit(distX(gen), distY(gen));
-        bool validPosition = true;
-
-        for (const auto &segment : snake)
-        {
-            if (segment == newFruit)
-            {
-                validPosition = false;
-                break;
-            }
-        }
-        if (validPosition)
+        if (action == GLFW_PRESS)
         {
-            fruit = newFruit;
-            break;
+            showOverlay = !showOverlay;
         }
+        return;
     }
-}
-
-void InitGame()
-{
-    ResetGame();
-    SpawnFruit();
-}
-
-void ResetGame()
-{
-    snake = {vec2i(5, 10), vec2i(4, 10), vec2i(3, 10)};
-    snakeDirection = Direction::None;
-    gameOver = false;
-    gameStarted = false;
-    score = 0;
-    timeSinceLastUpdate = 0.0f;
-    gameOverTime = 0.0f;
-    snakeSpeed = UPDATE_INTERVAL;
-}
-
-void KeyCallBackfun(GLFWwindow *window, int key, int scanCode, int action, int mods)
-{
     if (action == GLFW_PRESS)
     {
-        if (!gameStarted && key != GLFW_KEY_R)
+        if (!game.gameStarted && key != GLFW_KEY_R)
         {
-            gameStarted = true;
-            snakeDirection = Direction::Right;
+            game.Start();
             return;
         }
     }
-    if (gameOver && key == GLFW_KEY_R)
+    if (game.gameOver && key == GLFW_KEY_R)
     {
-        ResetGame();
-        SpawnFruit();
+        game.Restart();
         return;
     }
-    if (!gameOver && gameStarted)
+    if (!game.gameOver && game.gameStarted)
     {
         switch (key)
         {
         case GLFW_KEY_UP:
-        {
-            if (snakeDirection != Direction::Down)
-                snakeDirection = Direction::Up;
-        }
-        break;
+            game.Steer(Direction::Up);
+            break;
         case GLFW_KEY_DOWN:
-        {
-            if (snakeDirection != Direction::Up)
-                snakeDirection = Direction::Down;
-        }
-        break;
+            game.Steer(Direction::Down);
+            break;
         case GLFW_KEY_LEFT:
-        {
-            if (snakeDirection != Direction::Right)
-                snakeDirection = Direction::Left;
-        }
-        break;
+            game.Steer(Direction::Left);
+            break;
         case GLFW_KEY_RIGHT:
-        {
-            if (snakeDirection != Direction::Left)
-                snakeDirection = Direction::Right;
-        }
-        break;
+            game.Steer(Direction::Right);
+            break;
         default:
             break;
         }
     }
 }
 
-void DrawAnimatedGameOverBorder()
-{
-    float pulse = 0.5f + 0.5f * sin(gameOverTime * 6.0f);
-
-    vec3 borderColor(
-        0.6f + 0.4f * pulse,
-        0.1f,
-        0.1f);
-
-    for (int x = 0; x < GRID_WIDTH; x++)
-    {
-        DrawCell(vec2i(x, GRID_HIGHT - 1), borderColor);
-        DrawCell(vec2i(x, 0), borderColor);
-    }
-
-    for (int y = 0; y < GRID_HIGHT; y++)
-    {
-        DrawCell(vec2i(0, y), borderColor);
-        DrawCell(vec2i(GRID_WIDTH - 1, y), borderColor);
-    }
-}
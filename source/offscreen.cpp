@@ -0,0 +1,527 @@
+// Renders the game without a visible window, for golden-image checks and
+// render benchmarks.
+//
+// Three fixed scenes are built from a seeded GameState (start screen, a
+// game in progress and the game-over screen) and drawn with the same
+// GameRenderer as the windowed game into an offscreen framebuffer. With
+// --out each scene is written as <name>.png; with --golden each one is
+// compared against <name>.png in that directory and a mismatch is written
+// next to it as <name>.actual.png. --frames N draws every scene N more
+// times as fast as possible and reports the frame time. --software draws
+// with the CPU backend instead and needs no GL at all. --overlay adds the
+// performance overlay and prints the mean time of each render phase.
+// --board-texture draws the board with the GL backend's grid-state texture
+// pass instead of quads, and --damage turns on its damage tracking.
+// --parity N plays N ticks of a seeded game instead, drawing every frame
+// with both backends, and fails if any frame differs between them.
+//
+// The context comes from EGL with a pbuffer when the build found EGL, which
+// also works with no display at all (EGL_PLATFORM=surfaceless with Mesa),
+// and from a hidden GLFW window otherwise. Golden images are only
+// comparable between runs on the same GL implementation.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "Game.h"
+#include "GameRenderer.h"
+#include "Random.h"
+#include "SoftwareRenderer.h"
+
+#ifdef SNAKE_OFFSCREEN_EGL
+#include <EGL/egl.h>
+#else
+#include <GLFW/glfw3.h>
+#endif
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "stb_image_write.h"
+
+struct Scene
+{
+    const char *name;
+    GameSnapshot state;
+};
+
+#ifdef SNAKE_OFFSCREEN_EGL
+EGLDisplay display = EGL_NO_DISPLAY;
+EGLSurface surface = EGL_NO_SURFACE;
+EGLContext context = EGL_NO_CONTEXT;
+#else
+GLFWwindow *window = nullptr;
+#endif
+
+// A current GL 3.3 core context. Everything is drawn into a framebuffer
+// object, so the default surface is never read and can stay tiny.
+bool CreateContext()
+{
+#ifdef SNAKE_OFFSCREEN_EGL
+    display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr))
+    {
+        std::cerr << "EGL init failed\n";
+        return false;
+    }
+
+    const EGLint configAttribs[] = {EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+                                    EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+                                    EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8,
+                                    EGL_NONE};
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(display, configAttribs, &config, 1, &configCount) || configCount == 0)
+    {
+        std::cerr << "No EGL config with desktop OpenGL and pbuffers\n";
+        return false;
+    }
+
+    const EGLint surfaceAttribs[] = {EGL_WIDTH, 16, EGL_HEIGHT, 16, EGL_NONE};
+    surface = eglCreatePbufferSurface(display, config, surfaceAttribs);
+
+    const EGLint contextAttribs[] = {EGL_CONTEXT_MAJOR_VERSION, 3,
+                                     EGL_CONTEXT_MINOR_VERSION, 3,
+                                     EGL_CONTEXT_OPENGL_PROFILE_MASK,
+                                     EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                                     EGL_NONE};
+    eglBindAPI(EGL_OPENGL_API);
+    context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+    if (surface == EGL_NO_SURFACE || context == EGL_NO_CONTEXT ||
+        !eglMakeCurrent(display, surface, surface, context))
+    {
+        std::cerr << "EGL context creation failed\n";
+        return false;
+    }
+    return true;
+#else
+    if (!glfwInit())
+    {
+        std::cerr << "GLFW init failed\n";
+        return false;
+    }
+
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    window = glfwCreateWindow(16, 16, "SnakeOffscreen", nullptr, nullptr);
+    if (!window)
+    {
+        std::cerr << "Window creation failed\n";
+        return false;
+    }
+    glfwMakeContextCurrent(window);
+    return true;
+#endif
+}
+
+GLADloadproc ContextLoader()
+{
+#ifdef SNAKE_OFFSCREEN_EGL
+    return (GLADloadproc)eglGetProcAddress;
+#else
+    return (GLADloadproc)glfwGetProcAddress;
+#endif
+}
+
+void DestroyContext()
+{
+#ifdef SNAKE_OFFSCREEN_EGL
+    if (display != EGL_NO_DISPLAY)
+    {
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (context != EGL_NO_CONTEXT)
+            eglDestroyContext(display, context);
+        if (surface != EGL_NO_SURFACE)
+            eglDestroySurface(display, surface);
+        eglTerminate(display);
+    }
+#else
+    glfwTerminate();
+#endif
+}
+
+// The same scenes on every run: a fixed seed and scripted input, drawn
+// exactly at a tick (no interpolation) and at the start of the game-over
+// animation.
+std::vector<Scene> BuildScenes(int gridWidth, int gridHeight)
+{
+    std::vector<Scene> scenes;
+    GameState game;
+    game.SetGridSize(gridWidth, gridHeight);
+    game.Seed(1);
+
+    scenes.push_back({"start", GameSnapshot()});
+    game.TakeSnapshot(scenes.back().state);
+
+    // up, right along the top half, then back down past the start row
+    game.Start();
+    const char *script = "RRUUUURRRRDDDDDDRR";
+    for (const char *c = script; *c && !game.gameOver; c++)
+    {
+        game.Steer(*c == 'U'   ? Direction::Up
+                   : *c == 'D' ? Direction::Down
+                               : Direction::Right);
+        game.Step();
+    }
+    scenes.push_back({"play", GameSnapshot()});
+    game.TakeSnapshot(scenes.back().state);
+    scenes.back().state.tickAlpha = 1.0f;
+
+    while (!game.gameOver)
+    {
+        game.Step();
+    }
+    scenes.push_back({"over", GameSnapshot()});
+    game.TakeSnapshot(scenes.back().state);
+    return scenes;
+}
+
+// RGBA pixels, bottom row first as GL stores them, as a PNG.
+std::vector<unsigned char> EncodePNG(const void *pixels, int width, int height)
+{
+    std::vector<unsigned char> png;
+    auto append = [](void *context, void *data, int size)
+    {
+        auto *out = static_cast<std::vector<unsigned char> *>(context);
+        out->insert(out->end(), static_cast<unsigned char *>(data),
+                    static_cast<unsigned char *>(data) + size);
+    };
+    stbi_flip_vertically_on_write(1); // GL rows start at the bottom
+    stbi_write_png_to_func(append, &png, width, height, 4, pixels, width * 4);
+    return png;
+}
+
+std::vector<unsigned char> ReadFramebuffer(int width, int height)
+{
+    std::vector<unsigned char> pixels(size_t(width) * height * 4);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    return pixels;
+}
+
+bool ReadFile(const std::string &path, std::vector<unsigned char> &data)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+bool WriteFile(const std::string &path, const std::vector<unsigned char> &data)
+{
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char *>(data.data()), data.size());
+    return bool(file);
+}
+
+// A seeded game steered at the fruit, away from walls and its own body,
+// drawn twice a tick, part way and at the tick, and now and then only
+// after a few ticks have gone by, as after a slow frame. Each frame is
+// drawn by the GL backend and then by the software one, and the frames
+// that differ are counted. Retained GL frames build on the ones before,
+// so this covers what a single scene cannot.
+int CheckParity(int steps, int gridWidth, int gridHeight, int width, int height,
+                SoftwareRenderer &softwareRenderer)
+{
+    GameState game;
+    game.SetGridSize(gridWidth, gridHeight);
+    game.Seed(3);
+    Random random(3);
+    GameSnapshot state;
+    game.TakeSnapshot(state);
+    int frames = 0, mismatches = 0;
+
+    auto compare = [&](float alpha, float sinceSnapshot)
+    {
+        game.TakeSnapshot(state);
+        state.tickAlpha = alpha;
+        RenderGame(state, sinceSnapshot, width, height);
+        std::vector<unsigned char> pixels = ReadFramebuffer(width, height);
+        RenderGame(softwareRenderer, state, sinceSnapshot, width, height);
+        frames++;
+        if (std::memcmp(pixels.data(), softwareRenderer.Pixels(), pixels.size()) != 0)
+        {
+            if (mismatches++ < 10)
+            {
+                std::cerr << "parity: frame " << frames << " differs, tick " << state.moves
+                          << (state.gameOver ? ", game over" : state.gameStarted ? ", playing" : ", start")
+                          << "\n";
+            }
+        }
+    };
+
+    for (int step = 0; step < steps; step++)
+    {
+        if (game.gameOver)
+        {
+            game.Restart();
+        }
+        else if (!game.gameStarted)
+        {
+            game.Start();
+        }
+        else
+        {
+            // the snapshot is the game as last drawn, before this tick
+            const vec2i &head = state.snake.front();
+            auto neighbour = [&](Direction d)
+            {
+                return vec2i(head.x + (d == Direction::Right) - (d == Direction::Left),
+                             head.y + (d == Direction::Up) - (d == Direction::Down));
+            };
+            auto distance = [&](Direction d)
+            {
+                vec2i next = neighbour(d);
+                return std::abs(next.x - state.fruit.x) + std::abs(next.y - state.fruit.y);
+            };
+            Direction choices[4] = {Direction::Up, Direction::Down, Direction::Left, Direction::Right};
+            std::sort(choices, choices + 4, [&](Direction a, Direction b) { return distance(a) < distance(b); });
+            if (random.Next() % 4 == 0)
+            {
+                std::swap(choices[0], choices[random.Next() % 4]);
+            }
+            for (Direction choice : choices)
+            {
+                vec2i next = neighbour(choice);
+                if (next.x >= 0 && next.y >= 0 && next.x < gridWidth && next.y < gridHeight &&
+                    std::find(state.snake.begin(), state.snake.end() - 1, next) == state.snake.end() - 1)
+                {
+                    game.Steer(choice);
+                    break;
+                }
+            }
+            game.Step();
+            game.TakeSnapshot(state);
+            if (random.Next() % 8 == 0)
+            {
+                continue; // the next frame sees two ticks at once
+            }
+        }
+        compare(0.5f, 0.0f);
+        compare(1.0f, 0.1f);
+    }
+    std::cout << "parity: " << frames - mismatches << " of " << frames << " frames match\n";
+    return mismatches;
+}
+
+int main(int argc, char **argv)
+{
+    int width = 800;
+    int height = 600;
+    int gridWidth = DEFAULT_GRID_SIZE;
+    int gridHeight = DEFAULT_GRID_SIZE;
+    int frames = 0;
+    bool software = false;
+    bool overlay = false;
+    bool boardTexture = false;
+    bool damageTracking = false;
+    int paritySteps = 0;
+    std::string outDir, goldenDir;
+    const char *usage = " [--size WIDTHxHEIGHT] [--grid WIDTHxHEIGHT] [--frames N]"
+                        " [--out DIR] [--golden DIR] [--software] [--overlay]"
+                        " [--board-texture] [--damage] [--parity N]\n";
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--size" && i + 1 < argc)
+        {
+            if (std::sscanf(argv[++i], "%dx%d", &width, &height) != 2 || width < 1 || height < 1)
+            {
+                std::cerr << "Invalid image size, expected WIDTHxHEIGHT\n";
+                return -1;
+            }
+        }
+        else if (arg == "--grid" && i + 1 < argc)
+        {
+            if (std::sscanf(argv[++i], "%dx%d", &gridWidth, &gridHeight) != 2)
+            {
+                std::cerr << "Invalid grid size, expected WIDTHxHEIGHT\n";
+                return -1;
+            }
+        }
+        else if (arg == "--frames" && i + 1 < argc)
+        {
+            frames = std::max(0, std::atoi(argv[++i]));
+        }
+        else if (arg == "--out" && i + 1 < argc)
+        {
+            outDir = argv[++i];
+        }
+        else if (arg == "--golden" && i + 1 < argc)
+        {
+            goldenDir = argv[++i];
+        }
+        else if (arg == "--software")
+        {
+            software = true;
+        }
+        else if (arg == "--overlay")
+        {
+            overlay = true;
+        }
+        else if (arg == "--board-texture")
+        {
+            boardTexture = true;
+        }
+        else if (arg == "--damage")
+        {
+            damageTracking = true;
+        }
+        else if (arg == "--parity" && i + 1 < argc)
+        {
+            paritySteps = std::max(0, std::atoi(argv[++i]));
+        }
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << usage;
+            return -1;
+        }
+    }
+
+    if (gridWidth < Board::MIN_SIZE || gridWidth > Board::MAX_SIZE ||
+        gridHeight < Board::MIN_SIZE || gridHeight > Board::MAX_SIZE)
+    {
+        std::cerr << "Grid size must be between " << Board::MIN_SIZE << " and "
+                  << Board::MAX_SIZE << " cells per side\n";
+        return -1;
+    }
+
+    SoftwareRenderer softwareRenderer;
+    GLuint framebuffer = 0, colorBuffer = 0;
+    if (software)
+    {
+        std::cout << "renderer: software\n";
+    }
+    else
+    {
+        if (!CreateContext() || !InitGameRenderer(ContextLoader(), true, boardTexture, damageTracking))
+        {
+            DestroyContext();
+            return -1;
+        }
+        std::cout << "renderer: " << glGetString(GL_RENDERER) << "\n";
+
+        glGenFramebuffers(1, &framebuffer);
+        glGenRenderbuffers(1, &colorBuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        {
+            std::cerr << "Offscreen framebuffer is incomplete\n";
+            DestroyContext();
+            return -1;
+        }
+    }
+
+    SetPerfOverlay(overlay, HostStats());
+
+    if (paritySteps > 0)
+    {
+        int mismatches = 0;
+        if (software)
+        {
+            std::cerr << "--parity compares the GL backend with the software one, it needs GL\n";
+            mismatches = 1;
+        }
+        else
+        {
+            mismatches = CheckParity(paritySteps, gridWidth, gridHeight, width, height, softwareRenderer);
+            glDeleteFramebuffers(1, &framebuffer);
+            glDeleteRenderbuffers(1, &colorBuffer);
+            ShutdownGameRenderer();
+            DestroyContext();
+        }
+        return mismatches == 0 ? 0 : 1;
+    }
+
+    // one frame of a scene on whichever backend was chosen
+    auto draw = [&](const GameSnapshot &state)
+    {
+        if (software)
+            RenderGame(softwareRenderer, state, 0.0f, width, height);
+        else
+            RenderGame(state, 0.0f, width, height);
+    };
+
+    int mismatches = 0;
+    for (const Scene &scene : BuildScenes(gridWidth, gridHeight))
+    {
+        draw(scene.state);
+        std::vector<unsigned char> png =
+            software ? EncodePNG(softwareRenderer.Pixels(), width, height)
+                     : EncodePNG(ReadFramebuffer(width, height).data(), width, height);
+        std::string file = std::string(scene.name) + ".png";
+
+        if (!outDir.empty() && !WriteFile(outDir + "/" + file, png))
+        {
+            std::cerr << "Cannot write " << outDir << "/" << file << "\n";
+            mismatches++;
+        }
+
+        // stb's encoder is deterministic, so equal pixels give equal files
+        if (!goldenDir.empty())
+        {
+            std::vector<unsigned char> golden;
+            if (!ReadFile(goldenDir + "/" + file, golden))
+            {
+                std::cerr << scene.name << ": no golden image " << goldenDir << "/" << file << "\n";
+                mismatches++;
+            }
+            else if (golden != png)
+            {
+                std::string actual = goldenDir + "/" + scene.name + ".actual.png";
+                WriteFile(actual, png);
+                std::cerr << scene.name << ": differs from the golden image, wrote " << actual << "\n";
+                mismatches++;
+            }
+            else
+            {
+                std::cout << scene.name << ": matches\n";
+            }
+        }
+
+        if (frames > 0)
+        {
+            // glFinish every frame so GL times cover the GPU work as well
+            double total = 0.0, longest = 0.0;
+            for (int frame = 0; frame < frames; frame++)
+            {
+                auto start = std::chrono::high_resolution_clock::now();
+                draw(scene.state);
+                if (!software)
+                    glFinish();
+                double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+                total += seconds;
+                longest = std::max(longest, seconds);
+            }
+            std::cout << scene.name << ": " << frames << " frames at " << width << "x" << height
+                      << ", mean frame time: " << total / frames * 1000.0 << "ms"
+                      << ", longest: " << longest * 1000.0 << "ms"
+                      << ", " << frames / total << " frames/s\n";
+        }
+    }
+    PrintRenderStats(std::cout);
+
+    if (!software)
+    {
+        glDeleteFramebuffers(1, &framebuffer);
+        glDeleteRenderbuffers(1, &colorBuffer);
+        ShutdownGameRenderer();
+        DestroyContext();
+    }
+    return mismatches == 0 ? 0 : 1;
+}